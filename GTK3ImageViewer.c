@@ -4,11 +4,23 @@
 #include <string.h>
 #include <ctype.h>
 #include <gdk-pixbuf/gdk-pixbuf.h>
+#include <glib/gstdio.h>
+#ifdef G_OS_WIN32
+#include <windows.h>
+#endif
 
 #define SLIDESHOW_INTERVAL 3000 // 3 seconds
+#define PLAYLIST_LOOKAHEAD 64 // Playlist entries read ahead of the current image
+#define PLAYLIST_HISTORY 64 // Playlist entries kept behind the current image for going back
+#define PRERENDER_MAGIC 0x43504f48 // "HOPC"
+#define PRERENDER_VERSION 2
+#define FRAME_CACHE_SIZE (512 * 1024 * 1024) // Bytes of scaled frames kept in memory
+#define COMPRESSED_CACHE_SIZE (256 * 1024 * 1024) // Bytes of compressed frames kept behind them
+#define BENCH_RUNS 5 // Runs per --bench-wall figure, the median is reported
 //#define IMAGE_LABEL
 
 typedef struct {
+    int id; // Creation order, never reused
     GdkMonitor *monitor;
     GtkWindow *window;
     GtkWidget *scrolled_window;
@@ -23,7 +35,10 @@ typedef struct {
     guint timeout_id;
     int width;
     int height;
+    int alloc_width; // Last window allocation, kept so assignment never queries widgets
+    int alloc_height;
     int mode;
+    gboolean assigned; // Taken during the current mode 3 tick
     const char *current_image_path; // Path of the current image
 #ifdef IMAGE_LABEL
     GtkWidget *label; // Label to show file path and name
@@ -34,18 +49,91 @@ typedef struct {
     GList *image_node;
     GList *best_monitors;
     GdkPixbuf *pixbuf;
+    GdkPixbuf *frame; // Scaled for target, prepared off the main thread
+    MonitorData *target; // Monitor picked for this image in the current mode 3 tick
     int width;
     int height;
+    int frame_width; // Monitor size the frame was prepared for
+    int frame_height;
 } ImageData;
 
+// Monitors whose windows have the same size, images are matched against these instead of every monitor
+typedef struct {
+    int width;
+    int height;
+    GList *monitors; // In registry order
+} MonitorClass;
+
+// Exactly one of frame and compressed is set, compressed holds the frame's pixels deflated
+typedef struct {
+    char *key;
+    GdkPixbuf *frame;
+    GBytes *compressed;
+    int source_width;
+    int source_height;
+    int width;
+    int height;
+    int rowstride;
+    gboolean has_alpha;
+    gboolean evicting; // Picked by frame_cache_trim()
+    gsize bytes; // Uncompressed size
+} CachedFrame;
+
+typedef struct {
+    GDataInputStream *stream;
+    GCancellable *cancellable;
+    GList *tail; // Last entry read into images
+    char *base_dir; // Relative entries are resolved against this
+    gboolean rewindable; // Playlist files loop, stdin ends
+    gboolean reading;
+    gboolean eof;
+    gboolean any_valid; // Only loop a playlist that has shown something
+} PlaylistData;
+
+// Header of a prerendered frame file, the pixel rows follow it directly
+typedef struct {
+    guint32 magic;
+    guint32 version;
+    guint32 source_width; // Oriented size of the original image
+    guint32 source_height;
+    guint32 width;
+    guint32 height;
+    guint32 rowstride;
+    guint32 n_channels;
+    guint32 has_alpha;
+    guint32 path_length; // The image path follows the header, then the pixel rows
+    guint32 reserved;
+    gint64 source_size; // Image file size and mtime when prerendered, to find stale frames
+    gint64 source_mtime;
+} PrerenderHeader;
+
+typedef struct {
+    GArray *targets; // GdkRectangle, only width and height are used
+    GMutex lock;
+    int done;
+    int written;
+    int skipped;
+    int failed;
+    guint64 bytes_written;
+} PrerenderJob;
+
 static GList *images = NULL;
 static GList *current_image = NULL; // Apointer to an image in images
-static GList *current_pixbufs = NULL;
 static GList *next_pixbufs = NULL;
-static MonitorData *monitor_data = NULL; // Array of monitor data for all windows
+static MonitorData **monitor_data = NULL; // Registry of all windows, entries never move in memory
 static int num_monitors = 0;
+static int next_monitor_id = 0;
+static GArray *monitor_classes = NULL;
+static gboolean monitor_classes_dirty = TRUE;
+static GHashTable *frame_cache = NULL; // Key to link in frame_cache_lru
+static GQueue frame_cache_lru = G_QUEUE_INIT; // CachedFrame, most recently used first
+static gsize frame_cache_bytes = 0;
+static gsize compressed_cache_bytes = 0;
 static char **global_argv = NULL;
 static guint global_timeout_id = 0;
+static PlaylistData *playlist = NULL; // Set while images is a window onto a streamed playlist
+
+static void playlist_read_next(void);
 
 
 
@@ -77,6 +165,81 @@ static GList* get_image_files(const char *directory) {
     return images;
 }
 
+static void free_image_data(ImageData *image_data) {
+    if (image_data->pixbuf != NULL) {
+        g_object_unref(image_data->pixbuf);
+    }
+    if (image_data->frame != NULL) {
+        g_object_unref(image_data->frame);
+    }
+    g_list_free(image_data->best_monitors);
+    g_free(image_data);
+}
+
+static void clear_pending_images(void) {
+    g_list_free_full(next_pixbufs, (GDestroyNotify)free_image_data);
+    next_pixbufs = NULL;
+}
+
+static void set_current_image_before(GList *image_node) {
+    // Park current_image just before image_node so the next forward step lands on it, at the
+    // head that is NULL, which steps to images without wrapping through a streaming playlist
+    current_image = g_list_previous(image_node);
+}
+
+static void free_playlist(PlaylistData *data) {
+    g_object_unref(data->stream);
+    g_object_unref(data->cancellable);
+    g_free(data->base_dir);
+    g_free(data);
+}
+
+static void close_playlist(void) {
+    if (playlist == NULL) {
+        return;
+    }
+    // A pending read still owns the data, its callback frees it once cancelled
+    g_cancellable_cancel(playlist->cancellable);
+    if (!playlist->reading) {
+        free_playlist(playlist);
+    }
+    playlist = NULL;
+}
+
+static void replace_images(GList *new_images) {
+    close_playlist();
+
+    // Monitors hold borrowed pointers into the old catalogue, drop them before freeing it
+    for (int i = 0; i < num_monitors; i++) {
+        monitor_data[i]->current_image_path = NULL;
+    }
+    clear_pending_images();
+    g_list_free_full(images, g_free);
+    images = new_images;
+    current_image = NULL;
+}
+
+static void load_images_for_path(const char *path) {
+    GFile *file = g_file_new_for_path(path);
+    if (g_file_query_file_type(file, G_FILE_QUERY_INFO_NONE, NULL) == G_FILE_TYPE_DIRECTORY) {
+        replace_images(get_image_files(path));
+    } else if (has_image_extension(path)) {
+        char *directory = g_path_get_dirname(path);
+        replace_images(get_image_files(directory));
+#ifdef DEBUG
+        fprintf(stderr, "A file was passed and found %d files\n",g_list_length(images));
+#endif
+        g_free(directory);
+
+        // Set the specified file as the current image if it exists in the list
+        GList *file_node = g_list_find_custom(images, path, (GCompareFunc)g_strcmp0);
+        if (file_node) {
+            set_current_image_before(file_node);
+        }
+    }
+    g_object_unref(file);
+}
+
 static GdkPixbuf* rotate_pixbuf(GdkPixbuf *pixbuf, int orientation) {
     switch (orientation) {
         case 3:
@@ -111,30 +274,37 @@ static GdkPixbuf* new_pixbuf_respect_exif_orientation(const char *image_path) {
 
     return rotated_pixbuf;
 }
-static GtkImage* new_gtkImage_from_pixbuf(MonitorData *data, GdkPixbuf *pixbuf) {
+static GdkPixbuf* new_pixbuf_fit_to_size(GdkPixbuf *pixbuf, int max_width, int max_height) {
     int width = gdk_pixbuf_get_width(pixbuf);
     int height = gdk_pixbuf_get_height(pixbuf);
-    GtkImage *image = NULL;
-    if (data->shrink_to_fit && (width > data->width || height > data->height)) {
-        double aspect_ratio = (double)width / height;
-        int new_width = data->width;
-        int new_height = data->height;
-
-        if (width > height) {
-            new_height = (int)(data->width / aspect_ratio);
-            if (new_height > data->height) {
-                new_height = data->height;
-                new_width = (int)(data->height * aspect_ratio);
-            }
-        } else {
-            new_width = (int)(data->height * aspect_ratio);
-            if (new_width > data->width) {
-                new_width = data->width;
-                new_height = (int)(data->width / aspect_ratio);
-            }
+    if (width <= max_width && height <= max_height) {
+        return g_object_ref(pixbuf);
+    }
+    double aspect_ratio = (double)width / height;
+    int new_width = max_width;
+    int new_height = max_height;
+
+    if (width > height) {
+        new_height = (int)(max_width / aspect_ratio);
+        if (new_height > max_height) {
+            new_height = max_height;
+            new_width = (int)(max_height * aspect_ratio);
+        }
+    } else {
+        new_width = (int)(max_height * aspect_ratio);
+        if (new_width > max_width) {
+            new_width = max_width;
+            new_height = (int)(max_width / aspect_ratio);
         }
+    }
+
+    return gdk_pixbuf_scale_simple(pixbuf, new_width, new_height, GDK_INTERP_BILINEAR);
+}
 
-        GdkPixbuf *scaled_pixbuf = gdk_pixbuf_scale_simple(pixbuf, new_width, new_height, GDK_INTERP_BILINEAR);
+static GtkImage* new_gtkImage_from_pixbuf(MonitorData *data, GdkPixbuf *pixbuf) {
+    GtkImage *image = NULL;
+    if (data->shrink_to_fit) {
+        GdkPixbuf *scaled_pixbuf = new_pixbuf_fit_to_size(pixbuf, data->width, data->height);
         image = GTK_IMAGE(gtk_image_new_from_pixbuf(scaled_pixbuf));
         g_object_unref(scaled_pixbuf);
     }else {
@@ -142,6 +312,174 @@ static GtkImage* new_gtkImage_from_pixbuf(MonitorData *data, GdkPixbuf *pixbuf)
     }
     return image;
 }
+
+static char* prerender_cache_dir(void) {
+#ifdef G_OS_WIN32
+    // The default cache dir there is the Internet cache, which Disk Cleanup empties
+    if (g_getenv("XDG_CACHE_HOME") == NULL) {
+        return g_build_filename(g_get_user_data_dir(), "holosoptica", "cache", NULL);
+    }
+#endif
+    return g_build_filename(g_get_user_cache_dir(), "holosoptica", NULL);
+}
+
+/* Prerendered frames live in the user cache dir, one file per image and target size.
+The name is a SHA-256 of the canonical image path, size, mtime and target size, so an
+edited image or a different monitor simply misses instead of showing a stale frame.*/
+static char* prerender_cache_path(const char *image_path, const GStatBuf *stat_buf, int width, int height) {
+    // Playlists and command lines spell the same file differently, ./a.jpg must hit a/../a.jpg
+    char *canonical_path = g_canonicalize_filename(image_path, NULL);
+    char *key = g_strdup_printf("%s\n%" G_GINT64_FORMAT "\n%" G_GINT64_FORMAT "\n%dx%d", canonical_path,
+                                (gint64)stat_buf->st_size, (gint64)stat_buf->st_mtime, width, height);
+    char *digest = g_compute_checksum_for_string(G_CHECKSUM_SHA256, key, -1);
+    char *filename = g_strconcat(digest, ".hopc", NULL);
+    char *cache_dir = prerender_cache_dir();
+    char *cache_path = g_build_filename(cache_dir, filename, NULL);
+    g_free(cache_dir);
+    g_free(filename);
+    g_free(digest);
+    g_free(key);
+    g_free(canonical_path);
+    return cache_path;
+}
+
+static gboolean prerender_header_is_valid(const PrerenderHeader *header) {
+    return header->magic == PRERENDER_MAGIC && header->version == PRERENDER_VERSION &&
+           header->width > 0 && header->height > 0 &&
+           header->n_channels == (header->has_alpha ? 4u : 3u) &&
+           header->rowstride >= header->width * header->n_channels;
+}
+
+static gboolean prerender_cache_peek(const char *image_path, const GStatBuf *stat_buf, int width, int height, int *source_width, int *source_height) {
+    char *cache_path = prerender_cache_path(image_path, stat_buf, width, height);
+    FILE *file = g_fopen(cache_path, "rb");
+    g_free(cache_path);
+    if (file == NULL) {
+        return FALSE;
+    }
+    PrerenderHeader header;
+    gboolean found = fread(&header, sizeof(header), 1, file) == 1 && prerender_header_is_valid(&header);
+    fclose(file);
+    if (found) {
+        *source_width = header.source_width;
+        *source_height = header.source_height;
+    }
+    return found;
+}
+
+static void free_prerender_contents(guchar *pixels, gpointer data) {
+    g_free(data);
+}
+
+static GdkPixbuf* prerender_cache_load(const char *image_path, int width, int height) {
+    GStatBuf stat_buf;
+    if (g_stat(image_path, &stat_buf) != 0) {
+        return NULL;
+    }
+    char *cache_path = prerender_cache_path(image_path, &stat_buf, width, height);
+    gchar *contents = NULL;
+    gsize length = 0;
+    gboolean loaded = g_file_get_contents(cache_path, &contents, &length, NULL);
+    g_free(cache_path);
+    if (!loaded) {
+        return NULL;
+    }
+
+    PrerenderHeader header;
+    if (length < sizeof(header)) {
+        g_free(contents);
+        return NULL;
+    }
+    memcpy(&header, contents, sizeof(header));
+    gsize pixel_bytes = (gsize)(header.height - 1) * header.rowstride + (gsize)header.width * header.n_channels;
+    gsize pixel_offset = sizeof(header) + header.path_length;
+    if (!prerender_header_is_valid(&header) || length != pixel_offset + pixel_bytes) {
+        g_free(contents);
+        return NULL;
+    }
+    // The pixbuf takes over the file contents, no copy and no resampling
+    return gdk_pixbuf_new_from_data((guchar *)contents + pixel_offset, GDK_COLORSPACE_RGB, header.has_alpha, 8,
+                                    header.width, header.height, header.rowstride, free_prerender_contents, contents);
+}
+
+static gboolean prerender_cache_write(const char *cache_path, const char *image_path, const GStatBuf *stat_buf, GdkPixbuf *frame,
+                                      int source_width, int source_height, GError **error) {
+    char *canonical_path = g_canonicalize_filename(image_path, NULL);
+    gsize path_length = strlen(canonical_path);
+    PrerenderHeader header = {
+        .magic = PRERENDER_MAGIC,
+        .version = PRERENDER_VERSION,
+        .source_width = source_width,
+        .source_height = source_height,
+        .width = gdk_pixbuf_get_width(frame),
+        .height = gdk_pixbuf_get_height(frame),
+        .rowstride = gdk_pixbuf_get_rowstride(frame),
+        .n_channels = gdk_pixbuf_get_n_channels(frame),
+        .has_alpha = gdk_pixbuf_get_has_alpha(frame),
+        .path_length = path_length,
+        .source_size = stat_buf->st_size,
+        .source_mtime = stat_buf->st_mtime,
+    };
+    gsize pixel_bytes = gdk_pixbuf_get_byte_length(frame);
+    gsize length = sizeof(header) + path_length + pixel_bytes;
+    gchar *contents = g_malloc(length);
+    memcpy(contents, &header, sizeof(header));
+    memcpy(contents + sizeof(header), canonical_path, path_length);
+    memcpy(contents + sizeof(header) + path_length, gdk_pixbuf_read_pixels(frame), pixel_bytes);
+    // Written through a temporary file and renamed, a running viewer never sees half a frame
+    gboolean written = g_file_set_contents(cache_path, contents, length, error);
+    g_free(contents);
+    g_free(canonical_path);
+    return written;
+}
+
+/* A frame is stale once its image was edited or deleted, its key can never be built again.
+Only frames of images below directory are checked, other folders may be on a drive that is
+not mounted right now. Files of an older cache version are always removed.*/
+static int prerender_cache_prune(const char *directory) {
+    char *cache_dir = prerender_cache_dir();
+    GDir *dir = g_dir_open(cache_dir, 0, NULL);
+    if (dir == NULL) {
+        g_free(cache_dir);
+        return 0;
+    }
+    char *prefix = g_strconcat(directory, G_DIR_SEPARATOR_S, NULL);
+    int removed = 0;
+    const char *filename;
+    while ((filename = g_dir_read_name(dir)) != NULL) {
+        if (!g_str_has_suffix(filename, ".hopc")) {
+            continue;
+        }
+        char *cache_path = g_build_filename(cache_dir, filename, NULL);
+        FILE *file = g_fopen(cache_path, "rb");
+        PrerenderHeader header;
+        char *image_path = NULL;
+        gboolean stale = FALSE;
+        if (file != NULL) {
+            if (fread(&header, sizeof(header), 1, file) != 1 || header.magic != PRERENDER_MAGIC || header.version != PRERENDER_VERSION) {
+                stale = TRUE;
+            } else {
+                image_path = g_malloc0(header.path_length + 1);
+                stale = fread(image_path, 1, header.path_length, file) != header.path_length;
+            }
+            fclose(file);
+        }
+        if (image_path != NULL && !stale && g_str_has_prefix(image_path, prefix)) {
+            GStatBuf stat_buf;
+            stale = g_stat(image_path, &stat_buf) != 0 || (gint64)stat_buf.st_size != header.source_size ||
+                    (gint64)stat_buf.st_mtime != header.source_mtime;
+        }
+        if (stale && g_remove(cache_path) == 0) {
+            removed++;
+        }
+        g_free(image_path);
+        g_free(cache_path);
+    }
+    g_dir_close(dir);
+    g_free(prefix);
+    g_free(cache_dir);
+    return removed;
+}
 static void show_image_by_path(MonitorData *data, const char *image_path) {
     g_debug("Showing image: %s", image_path);
     // Check if the file exists
@@ -179,44 +517,123 @@ static void show_image_by_path(MonitorData *data, const char *image_path) {
     gtk_widget_show_all(GTK_WIDGET(data->scrolled_window));
 }
 
-static int compare_monitors(MonitorData *a, MonitorData *b) {
-    GtkAllocation allocation_a, allocation_b;
-    gtk_widget_get_allocation(GTK_WIDGET(a->window), &allocation_a);
-    gtk_widget_get_allocation(GTK_WIDGET(b->window), &allocation_b);
+static MonitorData* register_monitor(int width, int height) {
+    MonitorData *data = g_new0(MonitorData, 1);
+    data->id = next_monitor_id++;
+    data->shrink_to_fit = TRUE;
+    data->slideshow_active = TRUE;
+    data->is_fullscreen = TRUE;
+    data->width = width;
+    data->height = height;
+    data->alloc_width = width;
+    data->alloc_height = height;
+    data->mode = 1; // Default mode
+    if (num_monitors > 0) {
+        // A monitor added later follows the settings of the running ones
+        data->shrink_to_fit = monitor_data[0]->shrink_to_fit;
+        data->slideshow_active = monitor_data[0]->slideshow_active;
+        data->mode = monitor_data[0]->mode;
+    }
+
+    // Only the array of pointers grows, signal handlers keep pointing at the same MonitorData
+    monitor_data = g_renew(MonitorData *, monitor_data, num_monitors + 1);
+    monitor_data[num_monitors++] = data;
+    monitor_classes_dirty = TRUE;
+    return data;
+}
+
+static void unregister_monitor(MonitorData *data) {
+    int index = 0;
+    while (index < num_monitors && monitor_data[index] != data) {
+        index++;
+    }
+    if (index == num_monitors) {
+        return;
+    }
+    for (int j = index; j < num_monitors - 1; j++) {
+        monitor_data[j] = monitor_data[j + 1];
+    }
+    num_monitors--;
+
+    // Other monitors and pending images may still list this one as a best monitor
+    for (int i = 0; i < num_monitors; i++) {
+        monitor_data[i]->best_monitors = g_list_remove(monitor_data[i]->best_monitors, data);
+    }
+    for (GList *l = next_pixbufs; l != NULL; l = l->next) {
+        ImageData *image_data = (ImageData *)l->data;
+        image_data->best_monitors = g_list_remove(image_data->best_monitors, data);
+        if (image_data->target == data) {
+            image_data->target = NULL;
+        }
+    }
+    g_list_free(data->best_monitors);
+    g_free(data);
+    monitor_classes_dirty = TRUE;
+}
 
-    int resolution_a = allocation_a.width * allocation_a.height;
-    int resolution_b = allocation_b.width * allocation_b.height;
+static int compare_monitors(MonitorData *a, MonitorData *b) {
+    int resolution_a = a->alloc_width * a->alloc_height;
+    int resolution_b = b->alloc_width * b->alloc_height;
 
     if (resolution_a != resolution_b) {
         return resolution_a - resolution_b;
     } else {
-        return a - b;
+        return a->id - b->id;
+    }
+}
+
+static void update_monitor_classes(void) {
+    if (!monitor_classes_dirty) {
+        return;
+    }
+    if (monitor_classes == NULL) {
+        monitor_classes = g_array_new(FALSE, FALSE, sizeof(MonitorClass));
+    }
+    for (guint c = 0; c < monitor_classes->len; c++) {
+        g_list_free(g_array_index(monitor_classes, MonitorClass, c).monitors);
+    }
+    g_array_set_size(monitor_classes, 0);
+
+    for (int i = 0; i < num_monitors; i++) {
+        MonitorClass *monitor_class = NULL;
+        for (guint c = 0; c < monitor_classes->len && monitor_class == NULL; c++) {
+            MonitorClass *candidate = &g_array_index(monitor_classes, MonitorClass, c);
+            if (candidate->width == monitor_data[i]->alloc_width && candidate->height == monitor_data[i]->alloc_height) {
+                monitor_class = candidate;
+            }
+        }
+        if (monitor_class == NULL) {
+            MonitorClass new_class = { monitor_data[i]->alloc_width, monitor_data[i]->alloc_height, NULL };
+            g_array_append_val(monitor_classes, new_class);
+            monitor_class = &g_array_index(monitor_classes, MonitorClass, monitor_classes->len - 1);
+        }
+        monitor_class->monitors = g_list_prepend(monitor_class->monitors, monitor_data[i]);
     }
+    for (guint c = 0; c < monitor_classes->len; c++) {
+        MonitorClass *monitor_class = &g_array_index(monitor_classes, MonitorClass, c);
+        monitor_class->monitors = g_list_reverse(monitor_class->monitors);
+    }
+    monitor_classes_dirty = FALSE;
 }
 
 static GList* create_best_monitors_list(int width, int height) {
-    MonitorData *best_monitor = NULL;
     int best_scale_down = INT_MAX;
     GList *best_monitors = NULL;
 
-    for (int i = 0; i < num_monitors; i++) {
-        GtkAllocation allocation;
-        gtk_widget_get_allocation(GTK_WIDGET(monitor_data[i].window), &allocation);
-        int window_width = allocation.width;
-        int window_height = allocation.height;
-
-        int scale_down_width = (width > window_width) ? width - window_width : 0;
-        int scale_down_height = (height > window_height) ? height - window_height : 0;
+    // A video wall has many monitors but only a few distinct sizes, so score the sizes
+    update_monitor_classes();
+    for (guint c = 0; c < monitor_classes->len; c++) {
+        MonitorClass *monitor_class = &g_array_index(monitor_classes, MonitorClass, c);
+        int scale_down_width = (width > monitor_class->width) ? width - monitor_class->width : 0;
+        int scale_down_height = (height > monitor_class->height) ? height - monitor_class->height : 0;
         int scale_down = (scale_down_width > scale_down_height) ? scale_down_width : scale_down_height;
 
         if (scale_down < best_scale_down) {
-            if (best_monitors != NULL) {
-                g_list_free(best_monitors);
-            }
+            g_list_free(best_monitors);
             best_scale_down = scale_down;
-            best_monitors = g_list_append(NULL, &monitor_data[i]);
+            best_monitors = g_list_copy(monitor_class->monitors);
         } else if (scale_down == best_scale_down) {
-            best_monitors = g_list_append(best_monitors, &monitor_data[i]);
+            best_monitors = g_list_concat(best_monitors, g_list_copy(monitor_class->monitors));
         }
     }
 
@@ -296,187 +713,932 @@ static GList* create_best_monitors_list_by_image_path(const char *image_path) {
     g_object_unref(pixbuf);
     return create_best_monitors_list(width, height);
 }
-static GList* add_to_glist_image_data(GList *list, GList *image_node) {
-    if (image_node == NULL) {
-        return list;
+static gboolean find_prerendered_size(const char *image_path, int *width, int *height) {
+    GStatBuf stat_buf;
+    if (g_stat(image_path, &stat_buf) != 0) {
+        return FALSE;
     }
-    char *image_path = (char *)image_node->data;
-    GdkPixbuf *pixbuf = new_pixbuf_respect_exif_orientation(image_path);
-    if (!pixbuf) {
-        return list;
+    for (int i = 0; i < num_monitors; i++) {
+        // A video wall repeats a few sizes, only open the cache file once per size
+        gboolean probed = FALSE;
+        for (int j = 0; j < i && !probed; j++) {
+            probed = monitor_data[j]->width == monitor_data[i]->width && monitor_data[j]->height == monitor_data[i]->height;
+        }
+        if (!probed && prerender_cache_peek(image_path, &stat_buf, monitor_data[i]->width, monitor_data[i]->height, width, height)) {
+            return TRUE;
+        }
     }
-    int width = gdk_pixbuf_get_width(pixbuf);
-    int height = gdk_pixbuf_get_height(pixbuf);
-    if (width == 0 || height == 0) {
-        return list;
+    return FALSE;
+}
+
+static void run_in_parallel(GFunc func, GPtrArray *items) {
+    if (items->len < 2) {
+        for (guint i = 0; i < items->len; i++) {
+            func(g_ptr_array_index(items, i), NULL);
+        }
+        return;
     }
+    /* Uses GLib's shared worker threads, freeing the pool waits for every item. The main
+    thread is blocked meanwhile, so func may touch its item and read global state, but must
+    not change anything outside the item or call into GTK.*/
+    GThreadPool *pool = g_thread_pool_new(func, NULL, MIN(g_get_num_processors(), items->len), FALSE, NULL);
+    for (guint i = 0; i < items->len; i++) {
+        g_thread_pool_push(pool, g_ptr_array_index(items, i), NULL);
+    }
+    g_thread_pool_free(pool, FALSE, TRUE);
+}
 
-    ImageData *image_data = g_malloc(sizeof(ImageData));
-    image_data->image_node = image_node;
-    image_data->best_monitors = create_best_monitors_list(width, height);
-    image_data->pixbuf = pixbuf;
-    image_data->width = width;
-    image_data->height = height;
+static char* frame_cache_key(const char *image_path, int width, int height) {
+    return g_strdup_printf("%dx%d\n%s", width, height, image_path);
+}
 
-    return g_list_append(list, image_data);
+static void free_cached_frame(CachedFrame *cached) {
+    if (cached->frame != NULL) {
+        g_object_unref(cached->frame);
+    }
+    if (cached->compressed != NULL) {
+        g_bytes_unref(cached->compressed);
+    }
+    g_free(cached->key);
+    g_free(cached);
 }
 
-static void show_image_by_direction(gboolean next) {
-    if (current_image == NULL) {
-        current_image = images;
+static GList* frame_cache_find(const char *image_path, int width, int height) {
+    if (frame_cache == NULL) {
+        return NULL;
+    }
+    char *key = frame_cache_key(image_path, width, height);
+    GList *link = g_hash_table_lookup(frame_cache, key);
+    g_free(key);
+    return link;
+}
+
+static void frame_cache_remove(GList *link) {
+    CachedFrame *cached = (CachedFrame *)link->data;
+    g_hash_table_remove(frame_cache, cached->key);
+    g_queue_delete_link(&frame_cache_lru, link);
+    if (cached->frame != NULL) {
+        frame_cache_bytes -= cached->bytes;
     } else {
-        current_image = next ? g_list_next(current_image) : g_list_previous(current_image);
-        if (current_image == NULL) {
-            current_image = next ? images : g_list_last(images);
+        compressed_cache_bytes -= g_bytes_get_size(cached->compressed);
+    }
+    free_cached_frame(cached);
+}
+
+static GBytes* convert_bytes(GConverter *converter, const guint8 *data, gsize length) {
+    GByteArray *output = g_byte_array_sized_new(length / 2 + 1);
+    guint8 buffer[64 * 1024];
+    gsize offset = 0;
+    GConverterResult result;
+    do {
+        gsize bytes_read = 0;
+        gsize bytes_written = 0;
+        result = g_converter_convert(converter, data + offset, length - offset, buffer, sizeof(buffer),
+                                     G_CONVERTER_INPUT_AT_END, &bytes_read, &bytes_written, NULL);
+        if (result == G_CONVERTER_ERROR) {
+            g_byte_array_unref(output);
+            return NULL;
         }
+        offset += bytes_read;
+        g_byte_array_append(output, buffer, bytes_written);
+    } while (result != G_CONVERTER_FINISHED);
+    return g_byte_array_free_to_bytes(output);
+}
+
+// Only writes cached->compressed
+static void compress_frame_task(gpointer item, gpointer user_data) {
+    CachedFrame *cached = (CachedFrame *)item;
+    GConverter *compressor = G_CONVERTER(g_zlib_compressor_new(G_ZLIB_COMPRESSOR_FORMAT_RAW, 1));
+    cached->compressed = convert_bytes(compressor, gdk_pixbuf_read_pixels(cached->frame), cached->bytes);
+    g_object_unref(compressor);
+}
+
+// Only writes cached->frame, finish_restore() does the accounting on the main thread
+static void restore_frame_task(gpointer item, gpointer user_data) {
+    CachedFrame *cached = (CachedFrame *)item;
+    gsize compressed_length = 0;
+    const guint8 *compressed = g_bytes_get_data(cached->compressed, &compressed_length);
+    GConverter *decompressor = G_CONVERTER(g_zlib_decompressor_new(G_ZLIB_COMPRESSOR_FORMAT_RAW));
+    GBytes *pixels = convert_bytes(decompressor, compressed, compressed_length);
+    g_object_unref(decompressor);
+    if (pixels != NULL && g_bytes_get_size(pixels) == cached->bytes) {
+        cached->frame = gdk_pixbuf_new_from_bytes(pixels, GDK_COLORSPACE_RGB, cached->has_alpha, 8,
+                                                  cached->width, cached->height, cached->rowstride);
+    }
+    if (pixels != NULL) {
+        g_bytes_unref(pixels);
     }
+}
 
-    char *image_path = (char *)current_image->data;
-#ifdef DEBUG
-    g_debug("Navigating to image: %s", image_path);
-#endif    
+static void finish_compress(CachedFrame *cached) {
+    g_object_unref(cached->frame);
+    cached->frame = NULL;
+    frame_cache_bytes -= cached->bytes;
+    compressed_cache_bytes += g_bytes_get_size(cached->compressed);
+}
 
-    if (monitor_data->mode == 2) {
-        
-        if(next_pixbufs != NULL) {
-            g_list_free_full(next_pixbufs, (GDestroyNotify)g_free);
-            next_pixbufs = NULL;
-        }
-        next_pixbufs = add_to_glist_image_data(next_pixbufs, current_image);
-        GList *best_monitors = ((ImageData *)next_pixbufs->data)->best_monitors;
-        if (best_monitors != NULL) {
-            for (GList *l = best_monitors; l != NULL; l = l->next) {
-                MonitorData *monitor = (MonitorData *)l->data;
-                show_image_with_widget(monitor, new_gtkImage_from_pixbuf(monitor, ((ImageData*)next_pixbufs->data)->pixbuf));
-            }
-            g_list_free(best_monitors);
-        }
-        g_list_free_full(next_pixbufs, (GDestroyNotify)g_free);
-        next_pixbufs = NULL;
-/*11111111111111111111111111111111111111111111111111111111111111111111111111111111111111111111*/
-    } else if (monitor_data->mode == 1) {
-        if(next_pixbufs != NULL) {
-            g_list_free_full(next_pixbufs, (GDestroyNotify)g_free);
-            next_pixbufs = NULL;
-        }
-        next_pixbufs = add_to_glist_image_data(next_pixbufs, current_image);
-        GList *best_monitors = ((ImageData *)next_pixbufs->data)->best_monitors;
+static void finish_restore(CachedFrame *cached) {
+    compressed_cache_bytes -= g_bytes_get_size(cached->compressed);
+    g_bytes_unref(cached->compressed);
+    cached->compressed = NULL;
+    frame_cache_bytes += cached->bytes;
+}
 
-        if (best_monitors != NULL) {
-#ifdef DEBUG
-            g_warning("Mode 1: %s", image_path);
-#endif
-            best_monitors = g_list_sort(best_monitors, (GCompareFunc)compare_monitors);
-            if (!update_monitor_with_image_widget(best_monitors, new_gtkImage_from_pixbuf(((MonitorData *)best_monitors->data), ((ImageData*)next_pixbufs->data)->pixbuf), image_path)) {
-                //g_list_free(best_monitors);
-            }
-        }
-        g_list_free_full(next_pixbufs, (GDestroyNotify)g_free);
-        next_pixbufs = NULL;
-/*333333333333333333333333333333333333333333333333333333333333333333333333333333333333333333333*/
-    } else if (monitor_data->mode == 3) {
-#ifdef DEBUG
-            g_warning("Mode 3: %s", image_path);
-#endif
-        if (current_pixbufs != NULL) {
-            g_list_free_full(current_pixbufs, (GDestroyNotify)g_free);
-            current_pixbufs = NULL;
+static CachedFrame* frame_cache_lookup(const char *image_path, int width, int height) {
+    GList *link = frame_cache_find(image_path, width, height);
+    if (link == NULL) {
+        return NULL;
+    }
+    CachedFrame *cached = (CachedFrame *)link->data;
+    if (cached->frame == NULL) {
+        restore_frame_task(cached, NULL);
+        if (cached->frame == NULL) {
+            frame_cache_remove(link);
+            return NULL;
         }
-        GList *image_node = current_image;
-        int unshown_images = g_list_length(next_pixbufs);
-        for (int i = unshown_images; i < num_monitors; i++) {
-            if (image_node == NULL) {
-                image_node = images;
-            }
-            current_pixbufs = add_to_glist_image_data(current_pixbufs, image_node);
+        finish_restore(cached);
+    }
+    g_queue_unlink(&frame_cache_lru, link);
+    g_queue_push_head_link(&frame_cache_lru, link);
+    return cached;
+}
 
-            image_node = next ? g_list_next(image_node) : g_list_previous(image_node); 
-            if (image_node == NULL) {
-                image_node = next ? images : g_list_last(images);
+// Frames shown on a monitor, by its current image and size, and frames of images waiting in next_pixbufs
+static GHashTable* frame_cache_in_use(void) {
+    GHashTable *in_use = g_hash_table_new(g_direct_hash, g_direct_equal);
+    for (int i = 0; i < num_monitors; i++) {
+        if (monitor_data[i]->current_image_path != NULL) {
+            GList *link = frame_cache_find(monitor_data[i]->current_image_path, monitor_data[i]->width, monitor_data[i]->height);
+            if (link != NULL) {
+                g_hash_table_add(in_use, link->data);
             }
         }
-/*next we reverse the list and feed them in to the update_monitor_with_image_widget. Feeding the
-list in reverse ensures the first images get shown and any that can't be shown will be replaced.
-When next is false the list is created in reverse.*/
-        if(next) {
-            current_pixbufs = g_list_reverse(current_pixbufs);
-        }
-        if(next_pixbufs != NULL) {
-            next_pixbufs = g_list_reverse(next_pixbufs);
-            current_pixbufs = g_list_append(current_pixbufs, next_pixbufs);
-            next_pixbufs = NULL;
+    }
+    for (GList *l = next_pixbufs; l != NULL; l = l->next) {
+        ImageData *image_data = (ImageData *)l->data;
+        if (image_data->frame != NULL) {
+            GList *link = frame_cache_find((const char *)image_data->image_node->data, image_data->frame_width, image_data->frame_height);
+            if (link != NULL) {
+                g_hash_table_add(in_use, link->data);
+            }
         }
+    }
+    return in_use;
+}
 
-        for (GList *l = current_pixbufs; l != NULL; l = l->next) {
-            GList *next_best_monitors = ((ImageData *)l->data)->best_monitors;
-            const char *current_image_path = (char *)((ImageData *)l->data)->image_node->data;
-            MonitorData *monitor_data = (MonitorData *)next_best_monitors->data;
-            //monitor_data->current_image_path = current_image_path;
+/* Brings the uncompressed tier down to frame_budget, oldest first, by deflating frames into
+the compressed tier, then drops the oldest compressed frames past compressed_budget. Only the
+victims expected to fit in compressed_budget are deflated, the rest are dropped directly, so
+a zero compressed_budget deflates nothing. Frames pinned by frame_cache_in_use() are left
+alone, their pixels stay alive on screen either way.*/
+static void frame_cache_trim(gsize frame_budget, gsize compressed_budget) {
+    GHashTable *in_use = frame_cache_in_use();
+    GPtrArray *victims = g_ptr_array_new();
+    gsize remaining = frame_cache_bytes;
+    for (GList *l = frame_cache_lru.tail; l != NULL && remaining > frame_budget; l = l->prev) {
+        CachedFrame *cached = (CachedFrame *)l->data;
+        if (cached->frame != NULL && !g_hash_table_contains(in_use, cached)) {
+            cached->evicting = TRUE;
+            g_ptr_array_add(victims, l);
+            remaining -= cached->bytes;
+        }
+    }
 
-            if (next_best_monitors != NULL) {
-                next_best_monitors = g_list_sort(next_best_monitors, (GCompareFunc)compare_monitors);
-                update_monitor_with_image_widget(next_best_monitors, new_gtkImage_from_pixbuf(((MonitorData *)next_best_monitors->data), ((ImageData*)l->data)->pixbuf), current_image_path);
-                //g_list_free(next_best_monitors);
+    if (compressed_budget > 0 && victims->len > 0) {
+        // A frame's deflated size is only known afterwards, estimate it from the ones already compressed
+        gsize compressed_bytes = 0;
+        gsize source_bytes = 0;
+        for (GList *l = frame_cache_lru.head; l != NULL; l = l->next) {
+            CachedFrame *cached = (CachedFrame *)l->data;
+            if (cached->frame == NULL) {
+                compressed_bytes += g_bytes_get_size(cached->compressed);
+                source_bytes += cached->bytes;
             }
         }
-/*we now reverse the list back to correct order and look for images not shown,
-placing them in next_pixbufs to be shown on the next slideshow*/
-        current_pixbufs = g_list_reverse(current_pixbufs);
-        for (GList *l = current_pixbufs; l != NULL; l = l->next) {
-            gboolean found = FALSE;
-            for(int i = 0; i < num_monitors; i++) {
-                const char *current_image_path = (char *)((ImageData *)l->data)->image_node->data;
-                const char *monitor_path = monitor_data[i].current_image_path;
-                if (strcmp(current_image_path, monitor_path) == 0) {
-                    found = TRUE;
-                    break;
-                }
+        double ratio = source_bytes > 0 ? (double)compressed_bytes / source_bytes : 0.5;
+
+        // Newest first, the same order the compressed tier is trimmed in from the other end
+        GPtrArray *frames = g_ptr_array_sized_new(victims->len);
+        gsize expected = 0;
+        for (GList *l = frame_cache_lru.head; l != NULL; l = l->next) {
+            CachedFrame *cached = (CachedFrame *)l->data;
+            gsize size = cached->frame == NULL ? g_bytes_get_size(cached->compressed) : cached->evicting ? (gsize)(cached->bytes * ratio) : 0;
+            if (expected + size > compressed_budget) {
+                break;
             }
-            if (!found) {
-                next_pixbufs = add_to_glist_image_data(next_pixbufs, l->data);
+            expected += size;
+            if (cached->evicting) {
+                g_ptr_array_add(frames, cached);
             }
         }
-        g_list_free_full(current_pixbufs, (GDestroyNotify)g_free);
-        current_pixbufs = NULL;
+        run_in_parallel(compress_frame_task, frames);
+        g_ptr_array_free(frames, TRUE);
+    }
+    for (guint i = 0; i < victims->len; i++) {
+        GList *link = (GList *)g_ptr_array_index(victims, i);
+        CachedFrame *cached = (CachedFrame *)link->data;
+        cached->evicting = FALSE;
+        if (cached->compressed != NULL) {
+            finish_compress(cached);
+        } else {
+            frame_cache_remove(link);
+        }
+    }
+    g_ptr_array_free(victims, TRUE);
+    g_hash_table_destroy(in_use);
+
+    GList *l = frame_cache_lru.tail;
+    while (l != NULL && compressed_cache_bytes > compressed_budget) {
+        GList *newer = l->prev;
+        if (((CachedFrame *)l->data)->frame == NULL) {
+            frame_cache_remove(l);
+        }
+        l = newer;
     }
-}
-
-static gboolean on_timeout(gpointer user_data) {
 #ifdef DEBUG
-    g_warning("Slideshow timeout %s", current_image->data);
+    g_debug("Frame cache: %" G_GSIZE_FORMAT " bytes of frames, %" G_GSIZE_FORMAT " bytes compressed", frame_cache_bytes, compressed_cache_bytes);
 #endif
-    show_image_by_direction(TRUE);
-    return G_SOURCE_CONTINUE;
 }
 
-static void restart_slideshow() {
-    if (global_timeout_id != 0) {
-        g_source_remove(global_timeout_id);
+static void frame_cache_insert(const char *image_path, int width, int height, GdkPixbuf *frame, int source_width, int source_height) {
+    if (frame_cache == NULL) {
+        frame_cache = g_hash_table_new(g_str_hash, g_str_equal);
     }
-    global_timeout_id = g_timeout_add(SLIDESHOW_INTERVAL, on_timeout, NULL);
+    char *key = frame_cache_key(image_path, width, height);
+    if (g_hash_table_contains(frame_cache, key)) {
+        g_free(key);
+        return;
+    }
+    CachedFrame *cached = g_new0(CachedFrame, 1);
+    cached->key = key;
+    cached->frame = g_object_ref(frame);
+    cached->source_width = source_width;
+    cached->source_height = source_height;
+    cached->width = gdk_pixbuf_get_width(frame);
+    cached->height = gdk_pixbuf_get_height(frame);
+    cached->rowstride = gdk_pixbuf_get_rowstride(frame);
+    cached->has_alpha = gdk_pixbuf_get_has_alpha(frame);
+    cached->bytes = gdk_pixbuf_get_byte_length(frame);
+    g_queue_push_head(&frame_cache_lru, cached);
+    g_hash_table_insert(frame_cache, key, frame_cache_lru.head);
+    frame_cache_bytes += cached->bytes;
 }
 
-static void toggle_options_window(MonitorData *data) {
-    if (data->options_visible) {
-        gtk_widget_hide(data->options_window);
-        data->options_visible = FALSE;
-    } else {
-        gtk_widget_show_all(data->options_window);
-        data->options_visible = TRUE;
+/* Called once the new frames are on their monitors or in next_pixbufs, an insert in the
+middle of a batch would see the batch's own frames as unused. Trims to below the budget so
+the deflating happens in batches rather than after every tick.*/
+static void frame_cache_enforce_budget(void) {
+    if (frame_cache_bytes > FRAME_CACHE_SIZE) {
+        frame_cache_trim(FRAME_CACHE_SIZE / 4 * 3, COMPRESSED_CACHE_SIZE);
     }
 }
 
-static void create_options_window(MonitorData *data) {
-    data->options_window = gtk_window_new(GTK_WINDOW_TOPLEVEL);
-    gtk_window_set_title(GTK_WINDOW(data->options_window), "Options");
-    gtk_window_set_default_size(GTK_WINDOW(data->options_window), 200, 200);
-    gtk_window_set_keep_above(GTK_WINDOW(data->options_window), TRUE);
+static void frame_cache_clear(void) {
+    while (frame_cache_lru.head != NULL) {
+        frame_cache_remove(frame_cache_lru.head);
+    }
+}
 
-    GtkWidget *label = gtk_label_new(
-        "Key Press Options:\n"
-        "F/Escape: Toggle Fullscreen\n"
-        "Right Arrow: Next Image\n"
-        "Left Arrow: Previous Image\n"
+#if GLIB_CHECK_VERSION(2, 64, 0)
+static void on_low_memory_warning(GMemoryMonitor *monitor, GMemoryMonitorWarningLevel level, gpointer user_data) {
+    if (level >= G_MEMORY_MONITOR_WARNING_LEVEL_CRITICAL) {
+        // Keep only what is on screen, everything else can be read back from disk
+        frame_cache_trim(0, 0);
+        for (GList *l = next_pixbufs; l != NULL; l = l->next) {
+            ImageData *image_data = (ImageData *)l->data;
+            if (image_data->pixbuf != NULL) {
+                g_object_unref(image_data->pixbuf);
+                image_data->pixbuf = NULL;
+            }
+        }
+    } else if (level >= G_MEMORY_MONITOR_WARNING_LEVEL_MEDIUM) {
+        frame_cache_trim(0, COMPRESSED_CACHE_SIZE / 2);
+    } else {
+        frame_cache_trim(frame_cache_bytes / 2, COMPRESSED_CACHE_SIZE);
+    }
+}
+#endif
+
+static gboolean find_cached_size(const char *image_path, int *width, int *height) {
+    for (int i = 0; i < num_monitors; i++) {
+        GList *link = frame_cache_find(image_path, monitor_data[i]->width, monitor_data[i]->height);
+        if (link != NULL) {
+            CachedFrame *cached = (CachedFrame *)link->data;
+            *width = cached->source_width;
+            *height = cached->source_height;
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+static gboolean load_image_source(ImageData *image_data) {
+    const char *image_path = (const char *)image_data->image_node->data;
+    // A prerendered frame already knows the oriented size, only decode when there is none
+    if (find_prerendered_size(image_path, &image_data->width, &image_data->height)) {
+        return TRUE;
+    }
+    image_data->pixbuf = new_pixbuf_respect_exif_orientation(image_path);
+    if (image_data->pixbuf == NULL) {
+        return FALSE;
+    }
+    image_data->width = gdk_pixbuf_get_width(image_data->pixbuf);
+    image_data->height = gdk_pixbuf_get_height(image_data->pixbuf);
+    return TRUE;
+}
+
+static void load_image_source_task(gpointer item, gpointer user_data) {
+    load_image_source((ImageData *)item);
+}
+
+static GdkPixbuf* prepare_frame(ImageData *image_data, int width, int height) {
+    const char *image_path = (const char *)image_data->image_node->data;
+    GdkPixbuf *frame = prerender_cache_load(image_path, width, height);
+    if (frame != NULL) {
+        return frame;
+    }
+    if (image_data->pixbuf == NULL) {
+        image_data->pixbuf = new_pixbuf_respect_exif_orientation(image_path);
+        if (image_data->pixbuf == NULL) {
+            return NULL;
+        }
+    }
+    return new_pixbuf_fit_to_size(image_data->pixbuf, width, height);
+}
+
+static void prepare_frame_task(gpointer item, gpointer user_data) {
+    ImageData *image_data = (ImageData *)item;
+    image_data->frame = prepare_frame(image_data, image_data->frame_width, image_data->frame_height);
+}
+
+static ImageData* create_image_data(GList *image_node) {
+    if (image_node == NULL) {
+        return NULL;
+    }
+    ImageData *image_data = g_new0(ImageData, 1);
+    image_data->image_node = image_node;
+    if (!find_cached_size((const char *)image_node->data, &image_data->width, &image_data->height)) {
+        load_image_source(image_data);
+    }
+    if (image_data->width == 0 || image_data->height == 0) {
+        free_image_data(image_data);
+        return NULL;
+    }
+    return image_data;
+}
+
+static GtkImage* new_gtkImage_from_image_data(MonitorData *monitor, ImageData *image_data) {
+    const char *image_path = (const char *)image_data->image_node->data;
+    if (!monitor->shrink_to_fit) {
+        if (image_data->pixbuf == NULL) {
+            image_data->pixbuf = new_pixbuf_respect_exif_orientation(image_path);
+        }
+        return image_data->pixbuf != NULL ? new_gtkImage_from_pixbuf(monitor, image_data->pixbuf) : GTK_IMAGE(gtk_image_new());
+    }
+
+    GdkPixbuf *frame = NULL;
+    if (image_data->frame != NULL && image_data->frame_width == monitor->width && image_data->frame_height == monitor->height) {
+        frame = g_object_ref(image_data->frame);
+    } else {
+        CachedFrame *cached = frame_cache_lookup(image_path, monitor->width, monitor->height);
+        if (cached != NULL) {
+            frame = g_object_ref(cached->frame);
+        } else {
+            frame = prepare_frame(image_data, monitor->width, monitor->height);
+            if (frame != NULL) {
+                frame_cache_insert(image_path, monitor->width, monitor->height, frame, image_data->width, image_data->height);
+            }
+        }
+    }
+    if (frame == NULL) {
+        return GTK_IMAGE(gtk_image_new());
+    }
+    GtkImage *image = GTK_IMAGE(gtk_image_new_from_pixbuf(frame));
+    g_object_unref(frame);
+    return image;
+}
+
+static void assign_images_to_monitors(GPtrArray *batch) {
+    // One pass per tick: in priority order each image takes the first free monitor among its best ones
+    for (int i = 0; i < num_monitors; i++) {
+        monitor_data[i]->assigned = FALSE;
+    }
+    for (guint i = 0; i < batch->len; i++) {
+        ImageData *image_data = g_ptr_array_index(batch, i);
+        g_list_free(image_data->best_monitors);
+        image_data->best_monitors = NULL;
+        image_data->target = NULL;
+        if (image_data->width == 0 || image_data->height == 0) {
+            continue;
+        }
+        GList *best_monitors = create_best_monitors_list(image_data->width, image_data->height);
+        best_monitors = g_list_sort(best_monitors, (GCompareFunc)compare_monitors);
+        GList *free_link = best_monitors;
+        while (free_link != NULL && ((MonitorData *)free_link->data)->assigned) {
+            free_link = free_link->next;
+        }
+        if (free_link != NULL) {
+            // The target leads the list, mode 1 later moves the image along the rest of it
+            best_monitors = g_list_remove_link(best_monitors, free_link);
+            best_monitors = g_list_concat(free_link, best_monitors);
+            image_data->target = (MonitorData *)free_link->data;
+            image_data->target->assigned = TRUE;
+        }
+        image_data->best_monitors = best_monitors;
+    }
+}
+
+/* Everything a mode 3 tick needs short of touching widgets: decode what isn't cached,
+assign images to monitors, then scale each image for its monitor. Both expensive steps
+run across all cores.*/
+static void prepare_batch(GPtrArray *batch) {
+    GPtrArray *work = g_ptr_array_new();
+    for (guint i = 0; i < batch->len; i++) {
+        ImageData *image_data = g_ptr_array_index(batch, i);
+        const char *image_path = (const char *)image_data->image_node->data;
+        if (image_data->width == 0 && !find_cached_size(image_path, &image_data->width, &image_data->height)) {
+            g_ptr_array_add(work, image_data);
+        }
+    }
+    run_in_parallel(load_image_source_task, work);
+
+    assign_images_to_monitors(batch);
+
+    // Inflate the compressed frames this batch needs together instead of one by one in the lookup below
+    g_ptr_array_set_size(work, 0);
+    for (guint i = 0; i < batch->len; i++) {
+        ImageData *image_data = g_ptr_array_index(batch, i);
+        MonitorData *target = image_data->target;
+        if (target == NULL || !target->shrink_to_fit) {
+            continue;
+        }
+        GList *link = frame_cache_find((const char *)image_data->image_node->data, target->width, target->height);
+        // A small folder on a big wall puts the same image and size in a batch more than once
+        if (link != NULL && ((CachedFrame *)link->data)->frame == NULL && !g_ptr_array_find(work, link->data, NULL)) {
+            g_ptr_array_add(work, link->data);
+        }
+    }
+    run_in_parallel(restore_frame_task, work);
+    for (guint i = 0; i < work->len; i++) {
+        CachedFrame *cached = g_ptr_array_index(work, i);
+        if (cached->frame != NULL) {
+            finish_restore(cached);
+        }
+    }
+
+    g_ptr_array_set_size(work, 0);
+    for (guint i = 0; i < batch->len; i++) {
+        ImageData *image_data = g_ptr_array_index(batch, i);
+        MonitorData *target = image_data->target;
+        if (target == NULL || !target->shrink_to_fit) {
+            continue;
+        }
+        if (image_data->frame != NULL && image_data->frame_width == target->width && image_data->frame_height == target->height) {
+            continue;
+        }
+        if (image_data->frame != NULL) {
+            g_object_unref(image_data->frame);
+            image_data->frame = NULL;
+        }
+        image_data->frame_width = target->width;
+        image_data->frame_height = target->height;
+        CachedFrame *cached = frame_cache_lookup((const char *)image_data->image_node->data, target->width, target->height);
+        if (cached != NULL) {
+            image_data->frame = g_object_ref(cached->frame);
+        } else {
+            g_ptr_array_add(work, image_data);
+        }
+    }
+    run_in_parallel(prepare_frame_task, work);
+
+    for (guint i = 0; i < work->len; i++) {
+        ImageData *image_data = g_ptr_array_index(work, i);
+        if (image_data->frame != NULL) {
+            frame_cache_insert((const char *)image_data->image_node->data, image_data->frame_width, image_data->frame_height,
+                               image_data->frame, image_data->width, image_data->height);
+        }
+    }
+    g_ptr_array_free(work, TRUE);
+}
+
+static void show_assigned_image(ImageData *image_data) {
+    MonitorData *monitor = image_data->target;
+    GtkImage *gtk_image = new_gtkImage_from_image_data(monitor, image_data);
+
+    g_list_free(monitor->best_monitors);
+    monitor->best_monitors = image_data->best_monitors;
+    image_data->best_monitors = NULL;
+    monitor->gtk_image = GTK_WIDGET(gtk_image);
+    monitor->current_image_path = (const char *)image_data->image_node->data;
+    show_image_with_widget(monitor, gtk_image);
+}
+
+static gboolean image_node_in_use(GList *image_node) {
+    for (int i = 0; i < num_monitors; i++) {
+        if (monitor_data[i]->current_image_path == image_node->data) {
+            return TRUE;
+        }
+    }
+    for (GList *l = next_pixbufs; l != NULL; l = l->next) {
+        if (((ImageData *)l->data)->image_node == image_node) {
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+static void remove_image_node(GList *image_node) {
+    if (playlist != NULL && playlist->tail == image_node) {
+        playlist->tail = image_node->prev;
+    }
+    g_free(image_node->data);
+    images = g_list_delete_link(images, image_node);
+}
+
+static GList* validate_playlist_node(GList *image_node, gboolean next) {
+    // Playlist entries are unchecked when read, drop the ones that can't be shown as we reach them
+    while (image_node != NULL) {
+        if (image_node_in_use(image_node) || gdk_pixbuf_get_file_info((const char *)image_node->data, NULL, NULL) != NULL) {
+            playlist->any_valid = TRUE;
+            return image_node;
+        }
+        g_warning("Skipping playlist entry that is not a readable image: %s", (const char *)image_node->data);
+        GList *following = next ? image_node->next : image_node->prev;
+        remove_image_node(image_node);
+        image_node = following;
+        if (image_node == NULL && playlist->eof) {
+            image_node = next ? images : g_list_last(images);
+        }
+    }
+    return NULL;
+}
+
+static void trim_playlist_history(void) {
+    GList *oldest_kept = current_image;
+    for (int i = 0; oldest_kept != NULL && i < PLAYLIST_HISTORY; i++) {
+        oldest_kept = oldest_kept->prev;
+    }
+    if (oldest_kept == NULL) {
+        return;
+    }
+    while (images != oldest_kept && !image_node_in_use(images)) {
+        remove_image_node(images);
+    }
+}
+
+// TRUE while a playlist can still grow at the tail, the list must not wrap into history then
+static gboolean playlist_streaming(void) {
+    return playlist != NULL && !playlist->eof;
+}
+
+static void show_image_by_direction(gboolean next) {
+    GList *previous_image = current_image;
+    if (current_image == NULL) {
+        current_image = images;
+    } else {
+        current_image = next ? g_list_next(current_image) : g_list_previous(current_image);
+        if (current_image == NULL) {
+            if (playlist_streaming()) {
+                // Stay here until more of the playlist has been read
+                current_image = previous_image;
+                playlist_read_next();
+                return;
+            }
+            current_image = next ? images : g_list_last(images);
+        }
+    }
+    if (current_image == NULL) {
+        // Nothing to show yet, a streaming playlist may still deliver entries
+        playlist_read_next();
+        return;
+    }
+    if (playlist != NULL) {
+        // Validation only drops nodes on the far side of previous_image, so it stays valid
+        current_image = validate_playlist_node(current_image, next);
+        if (current_image == NULL) {
+            current_image = playlist_streaming() ? previous_image : NULL;
+            playlist_read_next();
+            return;
+        }
+        trim_playlist_history();
+        playlist_read_next();
+    }
+
+    char *image_path = (char *)current_image->data;
+#ifdef DEBUG
+    g_debug("Navigating to image: %s", image_path);
+#endif    
+
+    if (monitor_data[0]->mode == 2) {
+        clear_pending_images();
+        ImageData *image_data = create_image_data(current_image);
+        if (image_data != NULL) {
+            GList *best_monitors = create_best_monitors_list(image_data->width, image_data->height);
+            for (GList *l = best_monitors; l != NULL; l = l->next) {
+                MonitorData *monitor = (MonitorData *)l->data;
+                monitor->current_image_path = image_path;
+                show_image_with_widget(monitor, new_gtkImage_from_image_data(monitor, image_data));
+            }
+            g_list_free(best_monitors);
+            free_image_data(image_data);
+        }
+/*11111111111111111111111111111111111111111111111111111111111111111111111111111111111111111111*/
+    } else if (monitor_data[0]->mode == 1) {
+        clear_pending_images();
+        ImageData *image_data = create_image_data(current_image);
+        if (image_data != NULL) {
+            GList *best_monitors = create_best_monitors_list(image_data->width, image_data->height);
+            if (best_monitors != NULL) {
+#ifdef DEBUG
+                g_warning("Mode 1: %s", image_path);
+#endif
+                best_monitors = g_list_sort(best_monitors, (GCompareFunc)compare_monitors);
+                update_monitor_with_image_widget(best_monitors, new_gtkImage_from_image_data((MonitorData *)best_monitors->data, image_data), image_path);
+            }
+            free_image_data(image_data);
+        }
+/*333333333333333333333333333333333333333333333333333333333333333333333333333333333333333333333*/
+    } else if (monitor_data[0]->mode == 3) {
+#ifdef DEBUG
+            g_warning("Mode 3: %s", image_path);
+#endif
+/*Images that found no free monitor last tick go first, then the list is filled up from
+current_image. Earlier images in the batch get first pick of the monitors.*/
+        GPtrArray *batch = g_ptr_array_new();
+        for (GList *l = next_pixbufs; l != NULL; l = l->next) {
+            g_ptr_array_add(batch, l->data);
+        }
+        g_list_free(next_pixbufs);
+        next_pixbufs = NULL;
+
+        GList *image_node = current_image;
+        for (int i = batch->len; i < num_monitors; i++) {
+            ImageData *image_data = g_new0(ImageData, 1);
+            image_data->image_node = image_node;
+            g_ptr_array_add(batch, image_data);
+
+            image_node = next ? g_list_next(image_node) : g_list_previous(image_node);
+            if (image_node == NULL) {
+                if (playlist_streaming()) {
+                    break;
+                }
+                image_node = next ? images : g_list_last(images);
+            }
+        }
+
+        prepare_batch(batch);
+
+/*Each monitor gets at most one new widget per tick. Images whose best monitors were all
+taken are kept in next_pixbufs for the next slideshow.*/
+        for (guint i = 0; i < batch->len; i++) {
+            ImageData *image_data = g_ptr_array_index(batch, i);
+            if (image_data->target != NULL) {
+                show_assigned_image(image_data);
+                free_image_data(image_data);
+            } else if (image_data->width > 0 && image_data->height > 0) {
+                next_pixbufs = g_list_append(next_pixbufs, image_data);
+            } else {
+                free_image_data(image_data);
+            }
+        }
+        g_ptr_array_free(batch, TRUE);
+    }
+    frame_cache_enforce_budget();
+}
+
+static gboolean on_timeout(gpointer user_data) {
+    if (images == NULL) {
+        // The catalogue was replaced by an empty one, wait for the next path or drop
+        global_timeout_id = 0;
+        return G_SOURCE_REMOVE;
+    }
+#ifdef DEBUG
+    g_warning("Slideshow timeout %s", current_image->data);
+#endif
+    show_image_by_direction(TRUE);
+    return G_SOURCE_CONTINUE;
+}
+
+static void restart_slideshow() {
+    if (global_timeout_id != 0) {
+        g_source_remove(global_timeout_id);
+    }
+    global_timeout_id = g_timeout_add(SLIDESHOW_INTERVAL, on_timeout, NULL);
+}
+
+static void set_mode(int mode) {
+    for (int i = 0; i < num_monitors; i++) {
+        monitor_data[i]->mode = mode;
+    }
+}
+
+static void navigate(gboolean next) {
+    if (images == NULL && global_timeout_id != 0) {
+        // A path with no images leaves nothing to step through
+        g_source_remove(global_timeout_id);
+        global_timeout_id = 0;
+    }
+    if (num_monitors == 0 || images == NULL) {
+        return;
+    }
+    show_image_by_direction(next);
+    if (monitor_data[0]->slideshow_active) {
+        restart_slideshow();
+    }
+}
+
+static void show_image_by_filename(const char *path) {
+    // Reuse the running catalogue when the image is already in it, only rescan for a new folder
+    GList *file_node = g_list_find_custom(images, path, (GCompareFunc)g_strcmp0);
+    if (file_node != NULL) {
+        clear_pending_images();
+        set_current_image_before(file_node);
+    } else {
+        load_images_for_path(path);
+    }
+    navigate(TRUE);
+}
+
+static int count_images_ahead(int limit) {
+    int count = 0;
+    for (GList *l = current_image; l != NULL && count < limit; l = l->next) {
+        count++;
+    }
+    return count;
+}
+
+static void append_playlist_entry(char *entry) {
+    char *path = entry;
+    if (g_path_is_absolute(entry) || playlist->base_dir != NULL) {
+        // Canonical like the paths from the command line, so prerendered frames and goto match
+        path = g_canonicalize_filename(entry, playlist->base_dir);
+        g_free(entry);
+    }
+    if (playlist->tail == NULL) {
+        images = g_list_append(images, path);
+        playlist->tail = g_list_last(images);
+    } else {
+        g_list_append(playlist->tail, path);
+        playlist->tail = playlist->tail->next;
+    }
+}
+
+static void on_playlist_entry_read(GObject *source, GAsyncResult *result, gpointer user_data) {
+    PlaylistData *data = (PlaylistData *)user_data;
+    GDataInputStream *stream = G_DATA_INPUT_STREAM(source);
+    GError *error = NULL;
+    gsize length = 0;
+    char *entry = g_data_input_stream_read_upto_finish(stream, result, &length, &error);
+
+    data->reading = FALSE;
+    if (data != playlist) {
+        // Closed while this read was pending
+        g_free(entry);
+        g_clear_error(&error);
+        free_playlist(data);
+        return;
+    }
+    if (entry == NULL) {
+        if (error != NULL) {
+            g_warning("Failed to read playlist: %s", error->message);
+            g_error_free(error);
+            data->eof = TRUE;
+        } else if (data->rewindable && data->any_valid && g_seekable_seek(G_SEEKABLE(stream), 0, G_SEEK_SET, NULL, NULL)) {
+#ifdef DEBUG
+            g_debug("Playlist finished, starting over");
+#endif
+            playlist_read_next();
+        } else {
+            data->eof = TRUE;
+        }
+        return;
+    }
+
+    // read_upto leaves the separator buffered, nothing buffered means the last entry had none
+    if (g_buffered_input_stream_get_available(G_BUFFERED_INPUT_STREAM(stream)) > 0) {
+        g_data_input_stream_read_byte(stream, NULL, NULL);
+    }
+    if (length > 0 && entry[length - 1] == '\r') {
+        entry[--length] = '\0';
+    }
+    if (length > 0) {
+        append_playlist_entry(entry);
+    } else {
+        g_free(entry);
+    }
+
+    // The first entries start the show, later ones only top up the lookahead
+    if (current_image == NULL && images != NULL && num_monitors > 0) {
+        navigate(TRUE);
+    } else {
+        playlist_read_next();
+    }
+}
+
+static void playlist_read_next(void) {
+    static const char separators[] = { '\n', '\0' }; // Newline or NUL separated entries
+    if (playlist == NULL || playlist->reading || playlist->eof) {
+        return;
+    }
+    if (count_images_ahead(PLAYLIST_LOOKAHEAD) >= PLAYLIST_LOOKAHEAD) {
+        return;
+    }
+    playlist->reading = TRUE;
+    g_data_input_stream_read_upto_async(playlist->stream, separators, sizeof(separators), G_PRIORITY_DEFAULT_IDLE, playlist->cancellable, on_playlist_entry_read, playlist);
+}
+
+static void open_playlist(GApplicationCommandLine *cmdline, const char *arg) {
+    GInputStream *input = NULL;
+    char *base_dir = NULL;
+    gboolean rewindable = FALSE;
+
+    if (g_strcmp0(arg, "-") == 0) {
+        input = g_application_command_line_get_stdin(cmdline);
+        base_dir = g_strdup(g_application_command_line_get_cwd(cmdline));
+    } else {
+        GFile *file = g_application_command_line_create_file_for_arg(cmdline, arg);
+        GError *error = NULL;
+        input = G_INPUT_STREAM(g_file_read(file, NULL, &error));
+        if (input == NULL) {
+            g_application_command_line_printerr(cmdline, "Unable to open playlist %s: %s\n", arg, error->message);
+            g_error_free(error);
+        } else {
+            GFile *parent = g_file_get_parent(file);
+            if (parent != NULL) {
+                base_dir = g_file_get_path(parent);
+                g_object_unref(parent);
+            }
+            rewindable = TRUE;
+        }
+        g_object_unref(file);
+    }
+    if (input == NULL) {
+        g_free(base_dir);
+        return;
+    }
+
+    replace_images(NULL);
+    playlist = g_new0(PlaylistData, 1);
+    playlist->stream = g_data_input_stream_new(input);
+    playlist->cancellable = g_cancellable_new();
+    playlist->base_dir = base_dir;
+    playlist->rewindable = rewindable;
+    g_object_unref(input);
+
+    playlist_read_next();
+}
+
+static void on_action_next(GSimpleAction *action, GVariant *parameter, gpointer user_data) {
+    navigate(TRUE);
+}
+
+static void on_action_prev(GSimpleAction *action, GVariant *parameter, gpointer user_data) {
+    navigate(FALSE);
+}
+
+static void on_action_goto(GSimpleAction *action, GVariant *parameter, gpointer user_data) {
+    if (num_monitors > 0) {
+        show_image_by_filename(g_variant_get_string(parameter, NULL));
+    }
+}
+
+static void on_action_set_mode(GSimpleAction *action, GVariant *parameter, gpointer user_data) {
+    int mode = g_variant_get_int32(parameter);
+    if (mode >= 1 && mode <= 3) {
+        set_mode(mode);
+    }
+}
+
+// Exported on the session bus under the application id, e.g.
+// gapplication action com.example.MonitorSlideshow goto "'/path/to/image.jpg'"
+static const GActionEntry app_actions[] = {
+    { "next", on_action_next, NULL, NULL, NULL },
+    { "prev", on_action_prev, NULL, NULL, NULL },
+    { "goto", on_action_goto, "s", NULL, NULL },
+    { "set-mode", on_action_set_mode, "i", NULL, NULL },
+};
+
+static void toggle_options_window(MonitorData *data) {
+    if (data->options_visible) {
+        gtk_widget_hide(data->options_window);
+        data->options_visible = FALSE;
+    } else {
+        gtk_widget_show_all(data->options_window);
+        data->options_visible = TRUE;
+    }
+}
+
+static void create_options_window(MonitorData *data) {
+    data->options_window = gtk_window_new(GTK_WINDOW_TOPLEVEL);
+    gtk_window_set_title(GTK_WINDOW(data->options_window), "Options");
+    gtk_window_set_default_size(GTK_WINDOW(data->options_window), 200, 200);
+    gtk_window_set_keep_above(GTK_WINDOW(data->options_window), TRUE);
+
+    GtkWidget *label = gtk_label_new(
+        "Key Press Options:\n"
+        "F/Escape: Toggle Fullscreen\n"
+        "Right Arrow: Next Image\n"
+        "Left Arrow: Previous Image\n"
         "Space: Toggle Shrink to Fit\n"
         "S: Toggle Slideshow\n"
         "A: Toggle Actual Size\n"
@@ -506,13 +1668,13 @@ static gboolean on_key_press(GtkWidget *widget, GdkEventKey *event, gpointer use
         restart_slideshow();
     } else if (event->keyval == GDK_KEY_r) {
         for (int i = 0; i < num_monitors; i++) {
-            monitor_data[i].shrink_to_fit = !monitor_data[i].shrink_to_fit;
+            monitor_data[i]->shrink_to_fit = !monitor_data[i]->shrink_to_fit;
         }
         show_image_by_path((MonitorData *)user_data, (char *)current_image->data);
     } else if (event->keyval == GDK_KEY_s) {
         for (int i = 0; i < num_monitors; i++) {
-            monitor_data[i].slideshow_active = !monitor_data[i].slideshow_active;
-            if (monitor_data[i].slideshow_active) {
+            monitor_data[i]->slideshow_active = !monitor_data[i]->slideshow_active;
+            if (monitor_data[i]->slideshow_active) {
                 restart_slideshow();
             } else {
                 if (global_timeout_id != 0) {
@@ -523,25 +1685,19 @@ static gboolean on_key_press(GtkWidget *widget, GdkEventKey *event, gpointer use
         }
     } else if (event->keyval == GDK_KEY_a) {
         for (int i = 0; i < num_monitors; i++) {
-            monitor_data[i].actual_size = !monitor_data[i].actual_size;
+            monitor_data[i]->actual_size = !monitor_data[i]->actual_size;
         }
         show_image_by_path((MonitorData *)user_data, (char *)current_image->data);
     } else if (event->keyval == GDK_KEY_o) {
         for (int i = 0; i < num_monitors; i++) {
-            toggle_options_window(&monitor_data[i]);
+            toggle_options_window(monitor_data[i]);
         }
     } else if (event->keyval == GDK_KEY_1) {
-        for (int i = 0; i < num_monitors; i++) {
-            monitor_data[i].mode = 1;
-        }
+        set_mode(1);
     } else if (event->keyval == GDK_KEY_2) {
-        for (int i = 0; i < num_monitors; i++) {
-            monitor_data[i].mode = 2;
-        }
+        set_mode(2);
     } else if (event->keyval == GDK_KEY_3) {
-        for (int i = 0; i < num_monitors; i++) {
-            monitor_data[i].mode = 3;
-        }
+        set_mode(3);
     } else if (data->actual_size) {
         int dx = 0, dy = 0;
         if (event->keyval == GDK_KEY_Up) {
@@ -602,17 +1758,17 @@ static gboolean on_button_release(GtkWidget *widget, GdkEventButton *event, gpoi
 static void on_drag_data_received(GtkWidget *widget, GdkDragContext *context, gint x, gint y, GtkSelectionData *data, guint info, guint time, gpointer user_data) {
     gchar **uris = gtk_selection_data_get_uris(data);
     if (uris != NULL) {
-        g_list_free_full(images, g_free);
-        images = NULL;
+        GList *dropped_images = NULL;
         for (int i = 0; uris[i] != NULL; i++) {
             gchar *filepath = g_filename_from_uri(uris[i], NULL, NULL);
             if (filepath != NULL && has_image_extension(filepath)) {
-                images = g_list_append(images, filepath);
+                dropped_images = g_list_append(dropped_images, filepath);
             } else {
                 g_free(filepath);
             }
         }
         g_strfreev(uris);
+        replace_images(dropped_images);
         if (images != NULL) {
             current_image = images;
             show_image_by_direction(TRUE);
@@ -622,16 +1778,106 @@ static void on_drag_data_received(GtkWidget *widget, GdkDragContext *context, gi
     gtk_drag_finish(context, TRUE, FALSE, time);
 }
 
+static void on_size_allocate(GtkWidget *widget, GdkRectangle *allocation, gpointer user_data) {
+    MonitorData *data = (MonitorData *)user_data;
+    if (data->alloc_width != allocation->width || data->alloc_height != allocation->height) {
+        data->alloc_width = allocation->width;
+        data->alloc_height = allocation->height;
+        monitor_classes_dirty = TRUE;
+    }
+}
+
+static void refresh_monitor_image(MonitorData *data, GList *image_node) {
+    ImageData *image_data = create_image_data(image_node);
+    if (image_data == NULL) {
+        return;
+    }
+    GtkImage *gtk_image = new_gtkImage_from_image_data(data, image_data);
+    data->gtk_image = GTK_WIDGET(gtk_image);
+    data->current_image_path = (const char *)image_node->data;
+
+    // Rescore for the current monitor sizes, this monitor leads the list as mode 1 expects
+    GList *best_monitors = create_best_monitors_list(image_data->width, image_data->height);
+    best_monitors = g_list_sort(best_monitors, (GCompareFunc)compare_monitors);
+    best_monitors = g_list_remove(best_monitors, data);
+    g_list_free(data->best_monitors);
+    data->best_monitors = g_list_prepend(best_monitors, data);
+
+    show_image_with_widget(data, gtk_image);
+    free_image_data(image_data);
+    frame_cache_enforce_budget();
+}
+
+static void fullscreen_on_bound_monitor(MonitorData *data) {
+    // gtk_window_fullscreen() keeps a fullscreen window on its old output, name the output instead
+    GdkDisplay *display = gdk_monitor_get_display(data->monitor);
+    for (int i = 0; i < gdk_display_get_n_monitors(display); i++) {
+        if (gdk_display_get_monitor(display, i) == data->monitor) {
+            gtk_window_fullscreen_on_monitor(data->window, gtk_window_get_screen(data->window), i);
+            return;
+        }
+    }
+    gtk_window_fullscreen(data->window);
+}
+
+static void update_monitor_geometry(MonitorData *data) {
+    GdkRectangle geometry;
+    gdk_monitor_get_geometry(data->monitor, &geometry);
+    gtk_window_move(data->window, geometry.x, geometry.y);
+    gboolean resized = geometry.width != data->width || geometry.height != data->height;
+    if (resized) {
+#ifdef DEBUG
+        g_debug("Monitor %d is now %dx%d", data->id, geometry.width, geometry.height);
+#endif
+        data->width = geometry.width;
+        data->height = geometry.height;
+        // The window is resized to match, score with the new size before size-allocate arrives
+        data->alloc_width = geometry.width;
+        data->alloc_height = geometry.height;
+        monitor_classes_dirty = TRUE;
+        gtk_window_resize(data->window, geometry.width, geometry.height);
+    }
+    // Also when the size is unchanged, an adopted window may still be fullscreen on a removed output
+    if (data->is_fullscreen) {
+        fullscreen_on_bound_monitor(data);
+    }
+    if (!resized) {
+        return;
+    }
+    // Only this monitor's frame depends on its size, the other monitors and cached frames are left alone
+    GList *image_node = g_list_find(images, data->current_image_path);
+    if (image_node != NULL) {
+        refresh_monitor_image(data, image_node);
+    }
+}
+
+static void on_monitor_geometry_changed(GdkMonitor *monitor, GParamSpec *pspec, gpointer user_data) {
+    update_monitor_geometry((MonitorData *)user_data);
+}
+
+static void bind_monitor(MonitorData *data, GdkMonitor *monitor) {
+    data->monitor = g_object_ref(monitor);
+    g_signal_connect(monitor, "notify::geometry", G_CALLBACK(on_monitor_geometry_changed), data);
+}
+
+static void unbind_monitor(MonitorData *data) {
+    if (data->monitor == NULL) {
+        return;
+    }
+    g_signal_handlers_disconnect_by_data(data->monitor, data);
+    g_object_unref(data->monitor);
+    data->monitor = NULL;
+}
+
 static void on_window_destroy(GtkWidget *widget, gpointer user_data) {
     MonitorData *data = (MonitorData *)user_data;
 
-    // Free the best_monitors list if it exists
-    if (data->best_monitors != NULL) {
-        g_list_free(data->best_monitors);
-        data->best_monitors = NULL;
+    if (data->options_window != NULL) {
+        gtk_widget_destroy(data->options_window);
     }
+    unbind_monitor(data);
+    unregister_monitor(data);
 
-    num_monitors--;
     if (num_monitors == 0) {
         if (gtk_main_level() > 0) {
             gtk_main_quit();
@@ -640,19 +1886,101 @@ static void on_window_destroy(GtkWidget *widget, gpointer user_data) {
             g_source_remove(global_timeout_id);
             global_timeout_id = 0;
         }
-    } else {
-        int index = (MonitorData *)user_data - monitor_data;
-        for (int j = index; j < num_monitors; j++) {
-            monitor_data[j] = monitor_data[j + 1];
-        }
-        monitor_data = g_realloc(monitor_data, num_monitors * sizeof(MonitorData));
     }
 }
 
 
 
 
+static MonitorData* create_monitor_window(GtkApplication *app, GdkMonitor *monitor) {
+    GdkRectangle geometry;
+    gdk_monitor_get_geometry(monitor, &geometry);
+    MonitorData *data = register_monitor(geometry.width, geometry.height);
+
+    GtkWindow *window = GTK_WINDOW(gtk_application_window_new(app));
+    gtk_window_set_default_size(window, geometry.width, geometry.height);
+    gtk_window_move(window, geometry.x, geometry.y);
+    gtk_window_fullscreen(window);
+
+    GtkWidget *scrolled_window = gtk_scrolled_window_new(NULL, NULL);
+    gtk_scrolled_window_set_policy(GTK_SCROLLED_WINDOW(scrolled_window), GTK_POLICY_NEVER, GTK_POLICY_NEVER);
+    gtk_container_add(GTK_CONTAINER(window), scrolled_window);
+#ifdef IMAGE_LABEL
+    GtkWidget *label = gtk_label_new(NULL);
+    gtk_widget_set_halign(label, GTK_ALIGN_START);
+    gtk_widget_set_valign(label, GTK_ALIGN_END);
+    gtk_container_add(GTK_CONTAINER(window), label);
+    data->label = label;
+#endif
+    data->window = window;
+    data->scrolled_window = scrolled_window;
+    bind_monitor(data, monitor);
+
+    create_options_window(data);
+
+    g_signal_connect(window, "key-press-event", G_CALLBACK(on_key_press), data);
+    g_signal_connect(window, "motion-notify-event", G_CALLBACK(on_motion_notify), data);
+    g_signal_connect(window, "button-press-event", G_CALLBACK(on_button_press), data);
+    g_signal_connect(window, "button-release-event", G_CALLBACK(on_button_release), data);
+    g_signal_connect(window, "drag-data-received", G_CALLBACK(on_drag_data_received), data);
+    g_signal_connect(window, "size-allocate", G_CALLBACK(on_size_allocate), data);
+    g_signal_connect(window, "destroy", G_CALLBACK(on_window_destroy), data);
+
+    gtk_drag_dest_set(GTK_WIDGET(window), GTK_DEST_DEFAULT_ALL, NULL, 0, GDK_ACTION_COPY);
+    gtk_drag_dest_add_uri_targets(GTK_WIDGET(window));
+    
+    gtk_widget_add_events(GTK_WIDGET(window), GDK_POINTER_MOTION_MASK | GDK_BUTTON_PRESS_MASK | GDK_BUTTON_RELEASE_MASK);
+
+    gtk_widget_show_all(GTK_WIDGET(window));
+    return data;
+}
+
+static void on_monitor_added(GdkDisplay *display, GdkMonitor *monitor, gpointer user_data) {
+    MonitorData *data = NULL;
+    // A window left behind when the last monitor went away is reused rather than duplicated
+    for (int i = 0; i < num_monitors && data == NULL; i++) {
+        if (monitor_data[i]->monitor == NULL) {
+            data = monitor_data[i];
+        }
+    }
+    if (data != NULL) {
+        bind_monitor(data, monitor);
+        update_monitor_geometry(data);
+        return;
+    }
+
+    data = create_monitor_window(GTK_APPLICATION(user_data), monitor);
+    // Show something straight away, the next slideshow tick folds it into the rotation
+    if (current_image != NULL) {
+        refresh_monitor_image(data, current_image);
+    }
+}
+
+static void on_monitor_removed(GdkDisplay *display, GdkMonitor *monitor, gpointer user_data) {
+    for (int i = 0; i < num_monitors; i++) {
+        MonitorData *data = monitor_data[i];
+        if (data->monitor != monitor) {
+            continue;
+        }
+        if (num_monitors > 1) {
+            gtk_widget_destroy(GTK_WIDGET(data->window));
+        } else {
+            // Keep the last window, and with it the application and its caches, until a monitor comes back
+            unbind_monitor(data);
+        }
+        return;
+    }
+}
+
 static void activate(GtkApplication *app, gpointer user_data) {
+    // Windows already exist when re-activated over D-Bus, just raise them
+    if (num_monitors > 0) {
+        for (int i = 0; i < num_monitors; i++) {
+            gtk_window_present(monitor_data[i]->window);
+        }
+        return;
+    }
+
     GdkDisplay *display = gdk_display_get_default();
     if (display == NULL) {
         fprintf(stderr, "Unable to open display\n");
@@ -661,7 +1989,9 @@ static void activate(GtkApplication *app, gpointer user_data) {
 
     char *path = NULL;
 
-    if (global_argv[1]) {
+    if (playlist != NULL) {
+        // Entries arrive from the playlist stream once the windows exist
+    } else if (global_argv[1]) {
         path = g_strdup((const char *)global_argv[1]);
 #ifdef DEBUG
         fprintf(stderr, "Commandline path found\n");
@@ -671,93 +2001,30 @@ static void activate(GtkApplication *app, gpointer user_data) {
         path = g_build_filename(userprofile, "Pictures", NULL);
     }
 
-    GFile *file = g_file_new_for_path(path);
-    if (g_file_query_file_type(file, G_FILE_QUERY_INFO_NONE, NULL) == G_FILE_TYPE_DIRECTORY) {
-        images = get_image_files(path);
-    } else if (has_image_extension(path)) {
-        char *directory = g_path_get_dirname(path);
-        images = get_image_files(directory);
-#ifdef DEBUG
-        fprintf(stderr, "A file was passed and found %d files\n",g_list_length(images));
-#endif
-        g_free(directory);
-
-        // Set the specified file as the current image if it exists in the list
-        GList *file_node = g_list_find_custom(images, path, (GCompareFunc)g_strcmp0);
-        if (file_node) {
-            current_image = file_node;
-            // If there is more than one image, set the previous image as the current image
-            if (g_list_length(images) > 1) {
-                current_image = g_list_previous(current_image);
-                if (current_image == NULL) {
-                    current_image = g_list_last(images);
-                }
-            }
-        }
+    if (path != NULL) {
+        load_images_for_path(path);
     }
-    g_object_unref(file);
 
-    if (images == NULL) {
+    if (images == NULL && playlist == NULL) {
         fprintf(stderr, "No images found in the specified folder\n");
         //g_free(path);
         //return;
     }
 
-    num_monitors = gdk_display_get_n_monitors(display);
-    monitor_data = g_new0(MonitorData, num_monitors);
-
-    for (int i = 0; i < num_monitors; i++) {
-        GdkMonitor *monitor = gdk_display_get_monitor(display, i);
-        GdkRectangle geometry;
-        gdk_monitor_get_geometry(monitor, &geometry);
-
-        GtkWindow *window = GTK_WINDOW(gtk_application_window_new(app));
-        gtk_window_set_default_size(window, geometry.width, geometry.height);
-        gtk_window_move(window, geometry.x, geometry.y);
-        gtk_window_fullscreen(window);
-
-        GtkWidget *scrolled_window = gtk_scrolled_window_new(NULL, NULL);
-        gtk_scrolled_window_set_policy(GTK_SCROLLED_WINDOW(scrolled_window), GTK_POLICY_NEVER, GTK_POLICY_NEVER);
-        gtk_container_add(GTK_CONTAINER(window), scrolled_window);
-#ifdef IMAGE_LABEL
-        GtkWidget *label = gtk_label_new(NULL);
-        gtk_widget_set_halign(label, GTK_ALIGN_START);
-        gtk_widget_set_valign(label, GTK_ALIGN_END);
-        gtk_container_add(GTK_CONTAINER(window), label);
-        monitor_data[i].label = label;
-#endif
-        monitor_data[i].monitor = monitor;
-        monitor_data[i].window = window;
-        monitor_data[i].scrolled_window = scrolled_window;
-        monitor_data[i].gtk_image = NULL;
-        monitor_data[i].best_monitors = NULL;
-        monitor_data[i].shrink_to_fit = TRUE;
-        monitor_data[i].slideshow_active = TRUE;
-        monitor_data[i].is_fullscreen = TRUE;
-        monitor_data[i].actual_size = FALSE;
-        monitor_data[i].options_visible = FALSE;
-        monitor_data[i].timeout_id = 0;
-        monitor_data[i].width = geometry.width;
-        monitor_data[i].height = geometry.height;
-        monitor_data[i].mode = 1; // Default mode
-        monitor_data[i].current_image_path = NULL;
-
-        create_options_window(&monitor_data[i]);
-
-        g_signal_connect(window, "key-press-event", G_CALLBACK(on_key_press), &monitor_data[i]);
-        g_signal_connect(window, "motion-notify-event", G_CALLBACK(on_motion_notify), &monitor_data[i]);
-        g_signal_connect(window, "button-press-event", G_CALLBACK(on_button_press), &monitor_data[i]);
-        g_signal_connect(window, "button-release-event", G_CALLBACK(on_button_release), &monitor_data[i]);
-        g_signal_connect(window, "drag-data-received", G_CALLBACK(on_drag_data_received), &monitor_data[i]);
-        g_signal_connect(window, "destroy", G_CALLBACK(on_window_destroy), &monitor_data[i]);
-
-        gtk_drag_dest_set(GTK_WIDGET(window), GTK_DEST_DEFAULT_ALL, NULL, 0, GDK_ACTION_COPY);
-        gtk_drag_dest_add_uri_targets(GTK_WIDGET(window));
-        
-        gtk_widget_add_events(GTK_WIDGET(window), GDK_POINTER_MOTION_MASK | GDK_BUTTON_PRESS_MASK | GDK_BUTTON_RELEASE_MASK);
-
-        gtk_widget_show_all(GTK_WIDGET(window));
+    int n_monitors = gdk_display_get_n_monitors(display);
+    for (int i = 0; i < n_monitors; i++) {
+        create_monitor_window(app, gdk_display_get_monitor(display, i));
+    }
+    g_signal_connect(display, "monitor-added", G_CALLBACK(on_monitor_added), app);
+    g_signal_connect(display, "monitor-removed", G_CALLBACK(on_monitor_removed), app);
+#if GLIB_CHECK_VERSION(2, 64, 0)
+    // Backed by PSI on Linux, held for the lifetime of the process
+    static GMemoryMonitor *memory_monitor = NULL;
+    if (memory_monitor == NULL) {
+        memory_monitor = g_memory_monitor_dup_default();
+        g_signal_connect(memory_monitor, "low-memory-warning", G_CALLBACK(on_low_memory_warning), NULL);
     }
+#endif
 
     if(images){
         restart_slideshow();
@@ -771,24 +2038,323 @@ static int command_line(GApplication *app, GApplicationCommandLine *cmdline, gpo
 #ifdef DEBUG
     int i;
 #endif
-    global_argv = g_application_command_line_get_arguments(cmdline, &argc);
+    char **argv = g_application_command_line_get_arguments(cmdline, &argc);
 #ifdef DEBUG
     g_application_command_line_print (cmdline,
                                     "This text is written back\n"
                                     "to stdout of the caller\n");
 
     for (i = 0; i < argc; i++)
-        g_print ("argument %d: %s\n", i, global_argv[i]);
+        g_print ("argument %d: %s\n", i, argv[i]);
 #endif
+    // Resolve against the caller's working directory, a second launch may come from anywhere
+    if (argc > 2 && g_strcmp0(argv[1], "--playlist") == 0) {
+        open_playlist(cmdline, argv[2]);
+        if (num_monitors > 0) {
+            g_strfreev(argv);
+            g_application_activate(app);
+            return 0;
+        }
+    } else if (argc > 1) {
+        GFile *file = g_application_command_line_create_file_for_arg(cmdline, argv[1]);
+        char *resolved = g_file_get_path(file);
+        g_object_unref(file);
+        if (resolved != NULL) {
+            g_free(argv[1]);
+            argv[1] = resolved;
+        }
+    }
+
+    if (num_monitors > 0) {
+        // Primary instance already running: jump to the new path with the existing windows
+        if (argc > 1) {
+            show_image_by_filename(argv[1]);
+        }
+        g_strfreev(argv);
+        g_application_activate(app);
+        return 0;
+    }
+
+    g_strfreev(global_argv);
+    global_argv = argv;
     g_application_activate(app);
 
     return 0;
 }
 
+static void prerender_image(gpointer item, gpointer user_data) {
+    const char *image_path = (const char *)item;
+    PrerenderJob *job = (PrerenderJob *)user_data;
+    int written = 0, skipped = 0, failed = 0;
+    guint64 bytes_written = 0;
+    GdkPixbuf *pixbuf = NULL;
+    GStatBuf stat_buf;
+
+    if (g_stat(image_path, &stat_buf) != 0) {
+        failed = 1;
+    }
+    for (guint i = 0; !failed && i < job->targets->len; i++) {
+        GdkRectangle *target = &g_array_index(job->targets, GdkRectangle, i);
+        char *cache_path = prerender_cache_path(image_path, &stat_buf, target->width, target->height);
+        int source_width, source_height;
+        // A file from an older cache version has the same name, only a readable header counts
+        if (prerender_cache_peek(image_path, &stat_buf, target->width, target->height, &source_width, &source_height)) {
+            skipped++;
+        } else {
+            // Decode once per image and only if some target still needs a frame
+            if (pixbuf == NULL) {
+                pixbuf = new_pixbuf_respect_exif_orientation(image_path);
+            }
+            if (pixbuf == NULL) {
+                failed = 1;
+            } else {
+                GdkPixbuf *frame = new_pixbuf_fit_to_size(pixbuf, target->width, target->height);
+                GError *error = NULL;
+                if (prerender_cache_write(cache_path, image_path, &stat_buf, frame, gdk_pixbuf_get_width(pixbuf), gdk_pixbuf_get_height(pixbuf), &error)) {
+                    written++;
+                    bytes_written += sizeof(PrerenderHeader) + strlen(image_path) + gdk_pixbuf_get_byte_length(frame);
+                } else {
+                    g_warning("Failed to write %s: %s", cache_path, error->message);
+                    g_error_free(error);
+                    failed = 1;
+                }
+                g_object_unref(frame);
+            }
+        }
+        g_free(cache_path);
+    }
+    if (pixbuf != NULL) {
+        g_object_unref(pixbuf);
+    }
+
+    g_mutex_lock(&job->lock);
+    job->done++;
+    job->written += written;
+    job->skipped += skipped;
+    job->failed += failed;
+    job->bytes_written += bytes_written;
+    g_mutex_unlock(&job->lock);
+}
+
+static void add_prerender_target(GArray *targets, int width, int height) {
+    for (guint i = 0; i < targets->len; i++) {
+        GdkRectangle *target = &g_array_index(targets, GdkRectangle, i);
+        if (target->width == width && target->height == height) {
+            return;
+        }
+    }
+    GdkRectangle target = { 0, 0, width, height };
+    g_array_append_val(targets, target);
+}
+
+/* holosoptica --prerender DIR [WIDTHxHEIGHT ...]
+Renders every image in DIR at the given monitor sizes, or at the sizes of the current
+display's monitors when none are given, into the frame cache the viewer reads from.*/
+static int prerender_main(int argc, char *argv[]) {
+    // Cache keys hold the image path, so build them from the same absolute form the viewer uses
+    GFile *directory_file = g_file_new_for_commandline_arg(argv[2]);
+    char *directory = g_file_get_path(directory_file);
+    g_object_unref(directory_file);
+    if (directory == NULL) {
+        fprintf(stderr, "%s is not a local folder\n", argv[2]);
+        return 1;
+    }
+    GArray *targets = g_array_new(FALSE, FALSE, sizeof(GdkRectangle));
+
+    for (int i = 3; i < argc; i++) {
+        int width = 0, height = 0;
+        if (sscanf(argv[i], "%dx%d", &width, &height) != 2 || width <= 0 || height <= 0) {
+            fprintf(stderr, "Invalid monitor size %s, expected WIDTHxHEIGHT\n", argv[i]);
+            g_array_free(targets, TRUE);
+            g_free(directory);
+            return 1;
+        }
+        add_prerender_target(targets, width, height);
+    }
+    if (targets->len == 0 && gtk_init_check(NULL, NULL)) {
+        GdkDisplay *display = gdk_display_get_default();
+        for (int i = 0; i < gdk_display_get_n_monitors(display); i++) {
+            GdkRectangle geometry;
+            gdk_monitor_get_geometry(gdk_display_get_monitor(display, i), &geometry);
+            add_prerender_target(targets, geometry.width, geometry.height);
+        }
+    }
+    if (targets->len == 0) {
+        fprintf(stderr, "No display to read monitor sizes from, pass them as WIDTHxHEIGHT\n");
+        g_array_free(targets, TRUE);
+        g_free(directory);
+        return 1;
+    }
+
+    GList *prerender_images = get_image_files(directory);
+    int total = g_list_length(prerender_images);
+    if (total == 0) {
+        fprintf(stderr, "No images found in %s\n", directory);
+        g_array_free(targets, TRUE);
+        g_free(directory);
+        return 1;
+    }
+
+    char *cache_dir = prerender_cache_dir();
+    g_mkdir_with_parents(cache_dir, 0700);
+    fprintf(stderr, "Prerendering %d images for %u monitor sizes into %s\n", total, targets->len, cache_dir);
+    g_free(cache_dir);
+
+    PrerenderJob job = { .targets = targets };
+    g_mutex_init(&job.lock);
+    gint64 start_time = g_get_monotonic_time();
+    GThreadPool *pool = g_thread_pool_new(prerender_image, &job, g_get_num_processors(), TRUE, NULL);
+    for (GList *l = prerender_images; l != NULL; l = l->next) {
+        g_thread_pool_push(pool, l->data, NULL);
+    }
+
+    int done = 0;
+    while (done < total) {
+        g_usleep(G_USEC_PER_SEC / 2);
+        g_mutex_lock(&job.lock);
+        done = job.done;
+        guint64 bytes_written = job.bytes_written;
+        g_mutex_unlock(&job.lock);
+        double seconds = (g_get_monotonic_time() - start_time) / (double)G_USEC_PER_SEC;
+        fprintf(stderr, "\r%d/%d images, %.1f images/s, %.1f MB/s written", done, total,
+                done / seconds, bytes_written / seconds / (1024.0 * 1024.0));
+    }
+    g_thread_pool_free(pool, FALSE, TRUE);
+
+    double seconds = (g_get_monotonic_time() - start_time) / (double)G_USEC_PER_SEC;
+    fprintf(stderr, "\nDone in %.1f s: %d frames written (%.1f MB), %d already cached, %d images failed\n",
+            seconds, job.written, job.bytes_written / (1024.0 * 1024.0), job.skipped, job.failed);
+    int pruned = prerender_cache_prune(directory);
+    if (pruned > 0) {
+        fprintf(stderr, "Removed %d stale frames\n", pruned);
+    }
+
+    g_mutex_clear(&job.lock);
+    g_list_free_full(prerender_images, g_free);
+    g_array_free(targets, TRUE);
+    g_free(directory);
+    return job.failed > 0 ? 1 : 0;
+}
+
+#ifdef DEBUG
+static double bench_tick(GList *bench_images, int first_index, GdkPixbuf **sources) {
+    GPtrArray *batch = g_ptr_array_new();
+    GList *image_node = g_list_nth(bench_images, first_index);
+    for (int i = 0; i < num_monitors; i++) {
+        // Sources are synthetic, so decoding is not part of the timing
+        ImageData *image_data = g_new0(ImageData, 1);
+        image_data->image_node = image_node;
+        image_data->pixbuf = g_object_ref(sources[(first_index + i) % 2]);
+        image_data->width = gdk_pixbuf_get_width(image_data->pixbuf);
+        image_data->height = gdk_pixbuf_get_height(image_data->pixbuf);
+        g_ptr_array_add(batch, image_data);
+        image_node = image_node->next;
+    }
+
+    gint64 start_time = g_get_monotonic_time();
+    prepare_batch(batch);
+    double milliseconds = (g_get_monotonic_time() - start_time) / 1000.0;
+
+    g_ptr_array_foreach(batch, (GFunc)free_image_data, NULL);
+    g_ptr_array_free(batch, TRUE);
+    frame_cache_enforce_budget();
+    return milliseconds;
+}
+
+static int compare_doubles(const void *a, const void *b) {
+    double difference = *(const double *)a - *(const double *)b;
+    return (difference > 0) - (difference < 0);
+}
+
+/* holosoptica --bench-wall [MAX_OUTPUTS]
+Times the display-free part of a mode 3 tick on simulated monitors, alternating 1920x1080
+and 1080x1920, for 1, 2, 4 ... MAX_OUTPUTS outputs. The cold tick is the result that matters:
+it scales a frame for every output from an empty cache, so per-output cost only falls if the
+work spreads over the cores. The warm tick advances the slideshow by one image like the timer
+does and scales a single frame, it shows what the cache saves rather than how the wall scales.*/
+static int bench_wall_main(int argc, char *argv[]) {
+    int max_outputs = argc > 2 ? atoi(argv[2]) : 64;
+    GdkPixbuf *sources[2] = {
+        gdk_pixbuf_new(GDK_COLORSPACE_RGB, FALSE, 8, 4000, 3000),
+        gdk_pixbuf_new(GDK_COLORSPACE_RGB, FALSE, 8, 3000, 4000),
+    };
+    gdk_pixbuf_fill(sources[0], 0x336699ff);
+    gdk_pixbuf_fill(sources[1], 0x996633ff);
+
+    fprintf(stderr, "%u cores\noutputs  cold tick ms  cold ms/output  warm tick ms\n", g_get_num_processors());
+    double first_cold = 0;
+    double last_cold = 0;
+    int outputs = 1;
+    for (; outputs <= max_outputs; outputs *= 2) {
+        for (int i = 0; i < outputs; i++) {
+            register_monitor(i % 2 ? 1080 : 1920, i % 2 ? 1920 : 1080);
+        }
+        // These paths never resolve to a file or a prerendered frame
+        GList *bench_images = NULL;
+        for (int i = 0; i <= outputs; i++) {
+            bench_images = g_list_append(bench_images, g_strdup_printf("bench-%d", i));
+        }
+
+        double cold_runs[BENCH_RUNS];
+        double warm_runs[BENCH_RUNS];
+        for (int run = 0; run < BENCH_RUNS; run++) {
+            frame_cache_clear();
+            cold_runs[run] = bench_tick(bench_images, 0, sources);
+            warm_runs[run] = bench_tick(bench_images, 1, sources);
+        }
+        qsort(cold_runs, BENCH_RUNS, sizeof(double), compare_doubles);
+        qsort(warm_runs, BENCH_RUNS, sizeof(double), compare_doubles);
+        double cold = cold_runs[BENCH_RUNS / 2];
+        double warm = warm_runs[BENCH_RUNS / 2];
+        if (outputs == 1) {
+            first_cold = cold;
+        }
+        last_cold = cold;
+        fprintf(stderr, "%7d  %12.2f  %14.3f  %12.2f\n", outputs, cold, cold / outputs, warm);
+
+        frame_cache_clear();
+        g_list_free_full(bench_images, g_free);
+        while (num_monitors > 0) {
+            unregister_monitor(monitor_data[0]);
+        }
+    }
+    outputs /= 2;
+    if (outputs > 1 && first_cold > 0) {
+        fprintf(stderr, "cold tick grew %.1fx for %dx the outputs\n", last_cold / first_cold, outputs);
+    }
+
+    g_object_unref(sources[0]);
+    g_object_unref(sources[1]);
+    return 0;
+}
+#endif
+
+static void attach_parent_console(void) {
+#ifdef G_OS_WIN32
+    // Built with -mwindows there is no console, borrow the one we were started from unless stderr is redirected
+    if (GetStdHandle(STD_ERROR_HANDLE) == NULL && AttachConsole(ATTACH_PARENT_PROCESS)) {
+        freopen("CONOUT$", "w", stderr);
+    }
+#endif
+}
+
 int main(int argc, char *argv[]) {
+    // Headless, runs without a GtkApplication so it needs no display or running instance
+    if (argc > 2 && g_strcmp0(argv[1], "--prerender") == 0) {
+        attach_parent_console();
+        return prerender_main(argc, argv);
+    }
+#ifdef DEBUG
+    if (argc > 1 && g_strcmp0(argv[1], "--bench-wall") == 0) {
+        attach_parent_console();
+        return bench_wall_main(argc, argv);
+    }
+#endif
+
     GtkApplication *app = gtk_application_new("com.example.MonitorSlideshow", G_APPLICATION_HANDLES_COMMAND_LINE);
     g_signal_connect(app, "activate", G_CALLBACK(activate), NULL);
     g_signal_connect(app, "command-line", G_CALLBACK(command_line), NULL);
+    g_action_map_add_action_entries(G_ACTION_MAP(app), app_actions, G_N_ELEMENTS(app_actions), app);
 
     int status = g_application_run(G_APPLICATION(app), argc, argv);
     g_object_unref(app);